@@ -11,248 +11,5819 @@
  *
  * Data Structure:
  *   This version implements a Hash Table for efficient lookup by course number.
+ *   The table uses open addressing: courses are stored in one contiguous slot
+ *   array and located through one-byte control tags probed 16 at a time.
+ *
+ * Embedded (kiosk) build:
+ *   A fixed catalog can be compiled into the program so nothing is read at
+ *   startup and the load option disappears from the menu:
+ *     1. Generate a header from the catalog CSV:
+ *          <program> --embed-catalog courses.csv EmbeddedCatalog.h
+ *     2. Rebuild with ADVISING_EMBEDDED_CATALOG naming that header, e.g.
+ *          -DADVISING_EMBEDDED_CATALOG=\"EmbeddedCatalog.h\"
+ *
+ * Allocation-check build:
+ *   Defining ADVISING_COUNT_ALLOCATIONS replaces the global operator new
+ *   with a counting one, so --check-alloc can prove that lookups make no
+ *   heap allocation. Regular builds keep the standard allocator.
  *
  * Author: JakeTheSnake(JMG3000)
  * Date: 10/19/2025
  */
 
-#include <algorithm>
-#include <cctype>
-#include <fstream>
-#include <iostream>
-#include <sstream>
-#include <string>
-#include <vector>
-#include <list>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory_resource>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || (defined(_MSC_VER) && defined(_M_X64))
+#include <immintrin.h>
+#endif
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX  // keep min and max usable as the std algorithms
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// ===============================
+// STRUCT DEFINITION
+// ===============================
+
+// Integer key for a normalized course number. Identifiers of up to eight
+// ASCII characters ("CSCI200", "MATH1010") are packed big-endian into one
+// 64-bit value, so comparing two packed keys as integers orders them exactly
+// like the strings. Longer identifiers fall back to an interned string: the
+// top bit is set and the low bits index a process-wide table of long names.
+class CourseKey {
+public:
+    CourseKey() : code(0) {}
+
+    // Normalizes courseNumber and returns its key, interning it if it does
+    // not fit in eight characters
+    static CourseKey FromString(string_view courseNumber);
+
+    // Like FromString, but never interns: returns false for a long
+    // identifier that no course has used, since nothing can match it
+    static bool TryFind(string_view courseNumber, CourseKey& key);
+
+    uint64_t Code() const { return code; }
+    bool IsPacked() const { return (code & kOverflowFlag) == 0; }
+    string ToString() const;
+
+    friend bool operator==(CourseKey a, CourseKey b) { return a.code == b.code; }
+    friend bool operator!=(CourseKey a, CourseKey b) { return a.code != b.code; }
+    friend bool operator<(CourseKey a, CourseKey b);
+
+private:
+    static constexpr uint64_t kOverflowFlag = 1ULL << 63;
+
+    explicit CourseKey(uint64_t value) : code(value) {}
+
+    // Packs a trimmed identifier, upper-casing it on the way; fails when it
+    // is longer than eight characters or holds a byte outside 1..127
+    static bool Pack(string_view key, uint64_t& packed);
+
+    // Spelling of an interned long identifier
+    static string_view OverflowName(uint64_t index);
+
+    // Spelling of the key, written to buffer if it is packed
+    string_view Spell(char (&buffer)[8]) const;
+
+    uint64_t code;
+};
+
+// Handle to a course title in an interning pool (see TitlePool). Each
+// distinct title is stored once, in large shared blocks, and a course keeps
+// only its 32-bit ID instead of a string object and a heap allocation of
+// its own. Reading a title takes no lock.
+class CourseTitle {
+public:
+    CourseTitle() : id(0) {}  // the empty title
+
+    // Returns title, adding it to the current title pool (see TitleScope)
+    // if it is new
+    static CourseTitle FromString(string_view title);
+
+    uint32_t Id() const { return id; }
+    string_view View() const;  // valid while the pool holding it lives
+    string ToString() const { return string(View()); }
+
+    // Titles from one pool are never stored twice
+    friend bool operator==(CourseTitle a, CourseTitle b) { return a.id == b.id; }
+    friend bool operator!=(CourseTitle a, CourseTitle b) { return a.id != b.id; }
+
+private:
+    explicit CourseTitle(uint32_t value) : id(value) {}
+
+    uint32_t id;
+};
+
+// Prerequisite list with room for a few keys inside the course itself.
+// Most courses have three or fewer prerequisites, so they need no separate
+// block at all; a longer list moves to a buffer from the memory resource
+// the course was built with (the owning table's arena, for stored courses).
+class PrerequisiteList {
+public:
+    using allocator_type = pmr::polymorphic_allocator<CourseKey>;
+    using value_type = CourseKey;
+    using iterator = CourseKey*;
+    using const_iterator = const CourseKey*;
+
+    static constexpr uint32_t kInlineCapacity = 3;
+
+    PrerequisiteList() : PrerequisiteList(allocator_type()) {}
+    explicit PrerequisiteList(const allocator_type& alloc)
+        : resource(alloc.resource()), count(0), capacity(kInlineCapacity), local{} {}
+
+    PrerequisiteList(const PrerequisiteList& other) : PrerequisiteList(other, allocator_type()) {}
+    PrerequisiteList(const PrerequisiteList& other, const allocator_type& alloc) : PrerequisiteList(alloc) {
+        Assign(other.begin(), other.size());
+    }
+
+    // Takes over other's buffer; other is left empty
+    PrerequisiteList(PrerequisiteList&& other) noexcept : PrerequisiteList(allocator_type(other.resource)) {
+        Steal(other);
+    }
+    PrerequisiteList(PrerequisiteList&& other, const allocator_type& alloc) : PrerequisiteList(alloc) {
+        if (resource->is_equal(*other.resource)) {
+            Steal(other);
+        }
+        else {
+            Assign(other.begin(), other.size());
+        }
+    }
+
+    PrerequisiteList& operator=(const PrerequisiteList& other) {
+        if (this != &other) {
+            Assign(other.begin(), other.size());
+        }
+        return *this;
+    }
+    PrerequisiteList& operator=(PrerequisiteList&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (resource->is_equal(*other.resource)) {
+            FreeBuffer();
+            Steal(other);
+        }
+        else {
+            Assign(other.begin(), other.size());
+        }
+        return *this;
+    }
+
+    ~PrerequisiteList() { FreeBuffer(); }
+
+    void push_back(CourseKey key) {
+        if (count == capacity) {
+            Grow(capacity * 2);
+        }
+        Data()[count++] = key;
+    }
+
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool IsInline() const { return capacity == kInlineCapacity; }
+
+    // Bytes of the out-of-line buffer (0 while the keys fit inside)
+    size_t HeapBytes() const { return IsInline() ? 0 : capacity * sizeof(CourseKey); }
+
+    iterator begin() { return Data(); }
+    iterator end() { return Data() + count; }
+    const_iterator begin() const { return Data(); }
+    const_iterator end() const { return Data() + count; }
+    const CourseKey& operator[](size_t i) const { return Data()[i]; }
+
+    allocator_type get_allocator() const { return allocator_type(resource); }
+
+private:
+    CourseKey* Data() { return IsInline() ? local : heap; }
+    const CourseKey* Data() const { return IsInline() ? local : heap; }
+
+    void Assign(const CourseKey* keys, size_t n) {
+        if (n > capacity) {
+            Grow(static_cast<uint32_t>(n));
+        }
+        copy(keys, keys + n, Data());
+        count = static_cast<uint32_t>(n);
+    }
+
+    // Moves the keys to a buffer of newCapacity keys from the resource
+    void Grow(uint32_t newCapacity) {
+        CourseKey* buffer = static_cast<CourseKey*>(
+            resource->allocate(newCapacity * sizeof(CourseKey), alignof(CourseKey)));
+        copy(Data(), Data() + count, buffer);
+        FreeBuffer();
+        heap = buffer;
+        capacity = newCapacity;
+    }
+
+    void FreeBuffer() {
+        if (!IsInline()) {
+            resource->deallocate(heap, capacity * sizeof(CourseKey), alignof(CourseKey));
+            capacity = kInlineCapacity;
+        }
+    }
+
+    // Requires that this list holds no buffer and shares other's resource
+    void Steal(PrerequisiteList& other) {
+        if (other.IsInline()) {
+            copy(other.local, other.local + other.count, local);
+        }
+        else {
+            heap = other.heap;
+            capacity = other.capacity;
+            other.capacity = kInlineCapacity;
+        }
+        count = other.count;
+        other.count = 0;
+    }
+
+    pmr::memory_resource* resource;
+    uint32_t count;
+    uint32_t capacity;  // kInlineCapacity while the keys are in local
+    union {
+        CourseKey local[kInlineCapacity];
+        CourseKey* heap;
+    };
+};
+
+// Represents one course and its related information
+struct Course {
+    using allocator_type = PrerequisiteList::allocator_type;
+
+    CourseKey courseNumber;         // e.g., "CSCI200"
+    CourseTitle courseTitle;        // e.g., "Data Structures"
+    PrerequisiteList prerequisites; // e.g., {"CSCI101"}
+
+    Course() = default;
+    Course(const Course&) = default;
+    Course(Course&&) = default;
+    Course& operator=(const Course&) = default;
+    Course& operator=(Course&&) = default;
+
+    // Allocator-extended forms, so a pmr container of courses (e.g. a table
+    // backed by a CatalogArena) keeps the prerequisite lists in its memory
+    explicit Course(const allocator_type& alloc) : prerequisites(alloc) {}
+    Course(const Course& other, const allocator_type& alloc)
+        : courseNumber(other.courseNumber), courseTitle(other.courseTitle), prerequisites(other.prerequisites, alloc) {}
+    Course(Course&& other, const allocator_type& alloc)
+        : courseNumber(other.courseNumber), courseTitle(other.courseTitle), prerequisites(std::move(other.prerequisites), alloc) {}
+};
+
+// A course with up to PrerequisiteList::kInlineCapacity prerequisites is one
+// self-contained block that fits in a single cache line
+static_assert(sizeof(Course) <= 64, "Course should fit in one cache line");
+
+// ===============================
+// TEXT SCANNING
+// ===============================
+
+// Kernels that find CSV delimiters and whitespace boundaries many bytes at
+// a time, for the loader and Trim. Each has a byte-loop version, an SSE2
+// version (16 bytes a step, built wherever the compiler targets SSE2) and
+// an AVX2 version (32 bytes a step, chosen at run time when the processor
+// supports it). Whitespace means exactly space, tab, CR and LF, as in Trim.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ADVISING_AVX2_KERNELS
+#define ADVISING_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define ADVISING_AVX2_KERNELS
+#define ADVISING_TARGET_AVX2
+#endif
+
+// Index of the lowest set bit of a non-zero mask
+inline unsigned LowestSetBit(uint32_t mask) {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    unsigned index = 0;
+    while ((mask & 1u) == 0) {
+        mask >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// Index of the lowest set bit of a non-zero 64-bit mask
+inline unsigned LowestSetBit64(uint64_t mask) {
+    uint32_t low = static_cast<uint32_t>(mask);
+    return low != 0 ? LowestSetBit(low) : 32 + LowestSetBit(static_cast<uint32_t>(mask >> 32));
+}
+
+// Index of the highest set bit of a non-zero mask
+inline unsigned HighestSetBit(uint32_t mask) {
+#if defined(__GNUC__)
+    return 31u - static_cast<unsigned>(__builtin_clz(mask));
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    unsigned index = 0;
+    while (mask >>= 1) ++index;
+    return index;
+#endif
+}
+
+inline bool IsCSVSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Bits of the ',' and '\n' bytes among the 64 at block
+uint64_t DelimiterMaskScalar(const char* block) {
+    uint64_t mask = 0;
+    for (unsigned i = 0; i < 64; ++i) {
+        mask |= static_cast<uint64_t>(block[i] == ',' || block[i] == '\n') << i;
+    }
+    return mask;
+}
+
+// First non-whitespace character in [first, last), or last
+const char* SkipSpaceScalar(const char* first, const char* last) {
+    while (first != last && IsCSVSpace(*first)) ++first;
+    return first;
+}
+
+// One past the last non-whitespace character in [first, last), or first
+const char* SkipSpaceBackwardScalar(const char* first, const char* last) {
+    while (last != first && IsCSVSpace(last[-1])) --last;
+    return last;
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+// Bit i set when byte i is whitespace
+inline uint32_t SpaceMask(__m128i bytes) {
+    __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t')));
+    __m128i lineEnd = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(blank, lineEnd)));
+}
+
+uint64_t DelimiterMaskSse2(const char* block) {
+    uint64_t mask = 0;
+    for (unsigned i = 0; i < 64; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(',')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(hits))) << i;
+    }
+    return mask;
+}
+
+const char* SkipSpaceSse2(const char* first, const char* last) {
+    for (; last - first >= 16; first += 16) {
+        uint32_t mask = ~SpaceMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first))) & 0xFFFFu;
+        if (mask != 0) return first + LowestSetBit(mask);
+    }
+    return SkipSpaceScalar(first, last);
+}
+
+const char* SkipSpaceBackwardSse2(const char* first, const char* last) {
+    for (; last - first >= 16; last -= 16) {
+        uint32_t mask = ~SpaceMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(last - 16))) & 0xFFFFu;
+        if (mask != 0) return last - 16 + HighestSetBit(mask) + 1;
+    }
+    return SkipSpaceBackwardScalar(first, last);
+}
+#endif
+
+#ifdef ADVISING_AVX2_KERNELS
+ADVISING_TARGET_AVX2 inline uint32_t SpaceMask256(__m256i bytes) {
+    __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t')));
+    __m256i lineEnd = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(blank, lineEnd)));
+}
+
+ADVISING_TARGET_AVX2 uint64_t DelimiterMaskAvx2(const char* block) {
+    uint64_t mask = 0;
+    for (unsigned i = 0; i < 64; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+        __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(',')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')));
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hits))) << i;
+    }
+    return mask;
+}
+
+ADVISING_TARGET_AVX2 const char* SkipSpaceAvx2(const char* first, const char* last) {
+    for (; last - first >= 32; first += 32) {
+        uint32_t mask = ~SpaceMask256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)));
+        if (mask != 0) return first + LowestSetBit(mask);
+    }
+    return SkipSpaceScalar(first, last);
+}
+
+ADVISING_TARGET_AVX2 const char* SkipSpaceBackwardAvx2(const char* first, const char* last) {
+    for (; last - first >= 32; last -= 32) {
+        uint32_t mask = ~SpaceMask256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(last - 32)));
+        if (mask != 0) return last - 32 + HighestSetBit(mask) + 1;
+    }
+    return SkipSpaceBackwardScalar(first, last);
+}
+
+// True when the processor and the operating system both support AVX2
+bool CpuSupportsAvx2() {
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#endif
+}
+#endif
+
+// One set of scanning kernels
+struct TextScanner {
+    const char* name;
+    uint64_t (*delimiterMask)(const char* block);  // reads exactly 64 bytes
+    const char* (*skipSpace)(const char* first, const char* last);
+    const char* (*skipSpaceBackward)(const char* first, const char* last);
+};
+
+// The kernel sets this build and processor can run, slowest first
+vector<TextScanner> AvailableScanners() {
+    vector<TextScanner> scanners = {
+        { "scalar", DelimiterMaskScalar, SkipSpaceScalar, SkipSpaceBackwardScalar } };
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    scanners.push_back({ "SSE2", DelimiterMaskSse2, SkipSpaceSse2, SkipSpaceBackwardSse2 });
+#endif
+#ifdef ADVISING_AVX2_KERNELS
+    if (CpuSupportsAvx2()) {
+        scanners.push_back({ "AVX2", DelimiterMaskAvx2, SkipSpaceAvx2, SkipSpaceBackwardAvx2 });
+    }
+#endif
+    return scanners;
+}
+
+// The fastest available kernel set, picked on first use
+const TextScanner& Scanner() {
+    static const TextScanner best = AvailableScanners().back();
+    return best;
+}
+
+// Walks the ',' and '\n' positions of a text in order. Each 64-byte block
+// is classified once into a bitmask, and delimiters are then taken off the
+// mask one bit at a time, so short fields cost no rescanning.
+class DelimiterCursor {
+private:
+    const TextScanner& scanner;
+    const char* block;  // start of the block the mask covers
+    const char* end;
+    uint64_t mask;      // delimiters of the block not yet returned
+
+    void Classify() {
+        if (end - block >= 64) {
+            mask = scanner.delimiterMask(block);
+            return;
+        }
+        char tail[64] = {};  // the short last block, padded with NULs
+        copy(block, end, tail);
+        mask = scanner.delimiterMask(tail);
+    }
+
+public:
+    DelimiterCursor(const TextScanner& kernels, string_view text)
+        : scanner(kernels), block(text.data()), end(text.data() + text.size()), mask(0) {
+        if (block != end) Classify();
+    }
+
+    // Next delimiter, or the end of the text once there are no more
+    const char* Next() {
+        while (mask == 0) {
+            if (end - block <= 64) return end;
+            block += 64;
+            Classify();
+        }
+        const char* delimiter = block + LowestSetBit64(mask);
+        mask &= mask - 1;
+        return delimiter;
+    }
+};
+
+// ===============================
+// HELPER FUNCTIONS
+// ===============================
+
+// Removes leading and trailing whitespace without copying the characters
+string_view TrimView(string_view str) {
+    const TextScanner& scanner = Scanner();
+    const char* first = scanner.skipSpace(str.data(), str.data() + str.size());
+    const char* last = scanner.skipSpaceBackward(first, str.data() + str.size());
+    return string_view(first, static_cast<size_t>(last - first));
+}
+
+// Removes leading and trailing whitespace from a string
+string Trim(const string& str) {
+    return string(TrimView(str));
+}
+
+// Converts a string to uppercase for consistent comparisons
+string ToUpper(const string& s) {
+    string result = s;
+    transform(result.begin(), result.end(), result.begin(), ::toupper);
+    return result;
+}
+
+// Normalizes a course number by trimming and converting to uppercase
+string NormalizeCourseNumber(const string& s) {
+    return ToUpper(Trim(s));
+}
+
+// ===============================
+// COURSE KEY
+// ===============================
+
+// Array of pointers that readers index without a lock while a writer adds
+// entries. Entries live in chunks that double in size and never move, so a
+// reader never meets storage being replaced. Writers (Store) serialize
+// among themselves.
+template <typename T>
+class StableDirectory {
+public:
+    StableDirectory() = default;
+    StableDirectory(const StableDirectory&) = delete;
+    StableDirectory& operator=(const StableDirectory&) = delete;
+
+    // Entry index, which must have been stored
+    const T* Load(uint64_t index) const {
+        size_t chunk;
+        size_t offset;
+        Locate(index, chunk, offset);
+        return chunks[chunk].load(memory_order_acquire)[offset].load(memory_order_acquire);
+    }
+
+    // Sets entry index, adding its chunk if needed
+    void Store(uint64_t index, const T* value) {
+        size_t chunk;
+        size_t offset;
+        Locate(index, chunk, offset);
+        if (chunks[chunk].load(memory_order_relaxed) == nullptr) {
+            owned.push_back(make_unique<atomic<const T*>[]>(kFirstChunk << chunk));
+            chunks[chunk].store(owned.back().get(), memory_order_release);
+        }
+        chunks[chunk].load(memory_order_relaxed)[offset].store(value, memory_order_release);
+    }
+
+    // Bytes of the chunks added so far (writers only)
+    size_t BytesUsed() const {
+        size_t bytes = 0;
+        for (size_t chunk = 0; chunk < owned.size(); ++chunk) {
+            bytes += (kFirstChunk << chunk) * sizeof(atomic<const T*>);
+        }
+        return bytes;
+    }
+
+private:
+    static constexpr size_t kFirstChunk = 1024;  // chunk c holds kFirstChunk << c entries
+    static constexpr size_t kChunkCount = 48;
+
+    atomic<atomic<const T*>*> chunks[kChunkCount] = {};
+    vector<unique_ptr<atomic<const T*>[]>> owned;
+
+    static void Locate(uint64_t index, size_t& chunk, size_t& offset) {
+        uint64_t position = index + kFirstChunk;
+        chunk = 0;
+        while ((static_cast<uint64_t>(kFirstChunk) << (chunk + 1)) <= position) {
+            ++chunk;
+        }
+        offset = static_cast<size_t>(position - (static_cast<uint64_t>(kFirstChunk) << chunk));
+    }
+};
+
+// Process-wide table of identifiers too long to pack. Entries are only ever
+// added, and readers (a lookup, a key printed) never take its lock:
+//   - each name lives in a record that never moves once added;
+//   - names are found through an open-addressing index of record pointers,
+//     which is replaced by a copy twice the size when half full. Replaced
+//     indexes are kept, together no larger than the current one, so a
+//     reader still probing one stays safe;
+//   - records are found by index through a StableDirectory.
+// Only writers adding a name take the lock, to serialize among themselves.
+class OverflowKeyTable {
+public:
+    struct Name {
+        string text;
+        uint64_t index;
+    };
+
+    // The record of name, or null when no key has used it
+    const Name* Find(string_view name) const {
+        const Index* table = current.load(memory_order_acquire);
+        return table == nullptr ? nullptr : Probe(*table, name, HashName(name));
+    }
+
+    // The record of an interned index
+    const Name* At(uint64_t index) const {
+        return directory.Load(index);
+    }
+
+    // The record of name, adding it if it is new
+    const Name* Intern(string_view name) {
+        if (const Name* found = Find(name)) {
+            return found;
+        }
+
+        lock_guard<mutex> guard(lock);
+        uint64_t hashValue = HashName(name);
+        Index* table = current.load(memory_order_relaxed);
+        if (table != nullptr) {
+            if (const Name* found = Probe(*table, name, hashValue)) return found;
+        }
+
+        names.push_back(Name{ string(name), names.size() });
+        const Name* added = &names.back();
+
+        // The directory entry comes first: a reader that finds the name in
+        // the index may go on to look the record up by its index
+        directory.Store(added->index, added);
+
+        // Keep the index at most half full; the copy is complete before
+        // readers can see it
+        if (table == nullptr || names.size() * 2 > table->mask + 1) {
+            indexes.push_back(make_unique<Index>(table == nullptr ? kInitialSlots : (table->mask + 1) * 2));
+            Index* bigger = indexes.back().get();
+            for (const Name& n : names) {
+                if (&n != added) Place(*bigger, &n, HashName(n.text));
+            }
+            current.store(bigger, memory_order_release);
+            table = bigger;
+        }
+        Place(*table, added, hashValue);
+
+        return added;
+    }
+
+    // Approximate bytes held: each name's string (and its buffer, unless
+    // stored inline), the indexes and the directory
+    size_t BytesUsed() const {
+        lock_guard<mutex> guard(lock);
+        size_t bytes = 0;
+        for (const Name& name : names) {
+            const char* self = reinterpret_cast<const char*>(&name.text);
+            bool inlineText = name.text.data() >= self && name.text.data() < self + sizeof(string);
+            bytes += sizeof(Name) + (inlineText ? 0 : name.text.capacity() + 1);
+        }
+        for (const auto& index : indexes) {
+            bytes += (index->mask + 1) * sizeof(atomic<const Name*>);
+        }
+        return bytes + directory.BytesUsed();
+    }
+
+private:
+    static constexpr size_t kInitialSlots = 64;
+
+    struct Index {
+        size_t mask;  // slot count - 1
+        unique_ptr<atomic<const Name*>[]> slots;
+
+        explicit Index(size_t slotCount) : mask(slotCount - 1), slots(new atomic<const Name*>[slotCount]) {
+            for (size_t i = 0; i < slotCount; ++i) {
+                slots[i].store(nullptr, memory_order_relaxed);
+            }
+        }
+    };
+
+    mutable mutex lock;
+    deque<Name> names;                  // records; a deque never moves them
+    vector<unique_ptr<Index>> indexes;  // the current index and those it replaced
+    StableDirectory<Name> directory;    // record by index
+    atomic<Index*> current{ nullptr };
+
+    // FNV-1a; the index is picked from the low bits, which it mixes well
+    static uint64_t HashName(string_view name) {
+        uint64_t hashValue = 1469598103934665603ULL;
+        for (char c : name) {
+            hashValue = (hashValue ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+        }
+        return hashValue;
+    }
+
+    // The index is at most half full, so the probe always reaches an empty slot
+    static const Name* Probe(const Index& table, string_view name, uint64_t hashValue) {
+        for (size_t slot = static_cast<size_t>(hashValue) & table.mask; ; slot = (slot + 1) & table.mask) {
+            const Name* entry = table.slots[slot].load(memory_order_acquire);
+            if (entry == nullptr || entry->text == name) return entry;
+        }
+    }
+
+    static void Place(Index& table, const Name* name, uint64_t hashValue) {
+        size_t slot = static_cast<size_t>(hashValue) & table.mask;
+        while (table.slots[slot].load(memory_order_relaxed) != nullptr) {
+            slot = (slot + 1) & table.mask;
+        }
+        table.slots[slot].store(name, memory_order_release);
+    }
+};
+
+static OverflowKeyTable& OverflowKeys() {
+    static OverflowKeyTable table;
+    return table;
+}
+
+// Approximate bytes held by the long-identifier table
+static size_t OverflowKeyBytes() {
+    return OverflowKeys().BytesUsed();
+}
+
+bool CourseKey::Pack(string_view key, uint64_t& packed) {
+    if (key.size() > 8) return false;
+
+    packed = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        unsigned char c = 0;
+        if (i < key.size()) {
+            c = static_cast<unsigned char>(toupper(static_cast<unsigned char>(key[i])));
+            if (c == 0 || c > 127) return false;
+        }
+        packed = (packed << 8) | c;
+    }
+    return true;
+}
+
+string_view CourseKey::OverflowName(uint64_t index) {
+    return OverflowKeys().At(index)->text;
+}
+
+CourseKey CourseKey::FromString(string_view courseNumber) {
+    uint64_t packed;
+    string_view trimmed = TrimView(courseNumber);
+    if (Pack(trimmed, packed)) {
+        return CourseKey(packed);
+    }
+
+    string name = ToUpper(string(trimmed));
+    return CourseKey(kOverflowFlag | OverflowKeys().Intern(name)->index);
+}
+
+bool CourseKey::TryFind(string_view courseNumber, CourseKey& key) {
+    uint64_t packed;
+    string_view trimmed = TrimView(courseNumber);
+    if (Pack(trimmed, packed)) {
+        key = CourseKey(packed);
+        return true;
+    }
+
+    // Only long identifiers reach this point. They are upper-cased into a
+    // stack buffer, so a lookup allocates only for names too long for it,
+    // and looked up without a lock.
+    char buffer[64];
+    string longName;
+    string_view name;
+    if (trimmed.size() <= sizeof(buffer)) {
+        for (size_t i = 0; i < trimmed.size(); ++i) {
+            buffer[i] = static_cast<char>(toupper(static_cast<unsigned char>(trimmed[i])));
+        }
+        name = string_view(buffer, trimmed.size());
+    }
+    else {
+        longName = ToUpper(string(trimmed));
+        name = longName;
+    }
+
+    const OverflowKeyTable::Name* found = OverflowKeys().Find(name);
+    if (found == nullptr) {
+        return false;
+    }
+    key = CourseKey(kOverflowFlag | found->index);
+    return true;
+}
+
+string_view CourseKey::Spell(char (&buffer)[8]) const {
+    if (!IsPacked()) {
+        return OverflowName(code & ~kOverflowFlag);
+    }
+
+    size_t length = 0;
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        char c = static_cast<char>((code >> shift) & 0xFF);
+        if (c == 0) break;
+        buffer[length++] = c;
+    }
+    return string_view(buffer, length);
+}
+
+string CourseKey::ToString() const {
+    char buffer[8];
+    return string(Spell(buffer));
+}
+
+// Packed keys compare as integers; only long identifiers compare as text,
+// read in place, so comparing keys never allocates
+bool operator<(CourseKey a, CourseKey b) {
+    if (a.IsPacked() && b.IsPacked()) {
+        return a.code < b.code;
+    }
+    char bufferA[8];
+    char bufferB[8];
+    return a.Spell(bufferA) < b.Spell(bufferB);
+}
+
+ostream& operator<<(ostream& out, CourseKey key) {
+    return out << key.ToString();
+}
+
+// A normalized course number to compare stored keys against. Unlike a
+// CourseKey it can be made from any text, including long identifiers no
+// course uses, so it can mark the ends of a range or the start of a prefix.
+class CourseKeyBound {
+public:
+    explicit CourseKeyBound(string_view courseNumber)
+        : text(ToUpper(string(TrimView(courseNumber)))) {
+        hasKey = CourseKey::TryFind(text, key);
+    }
+
+    const string& Text() const { return text; }
+
+    friend bool operator<(CourseKey a, const CourseKeyBound& b) {
+        return b.hasKey ? a < b.key : a.ToString() < b.text;
+    }
+    friend bool operator<(const CourseKeyBound& a, CourseKey b) {
+        return a.hasKey ? a.key < b : a.text < b.ToString();
+    }
+    friend bool operator<(const CourseKeyBound& a, const CourseKeyBound& b) {
+        return a.text < b.text;
+    }
+
+private:
+    string text;
+    CourseKey key;  // valid when hasKey
+    bool hasKey;
+};
+
+// ===============================
+// CSV PARSING
+// ===============================
+
+// Splits a CSV line into tokens
+vector<string> SplitCSV(const string& line) {
+    vector<string> tokens;
+    string token;
+    stringstream ss(line);
+    while (getline(ss, token, ',')) {
+        tokens.push_back(Trim(token));
+    }
+    return tokens;
+}
+
+// Calls visit(lineNumber, tokens) for each non-blank line of text, where
+// tokens are the line's trimmed fields as views into text. Lines are
+// numbered from 1, blank lines included, so messages can point into the
+// file. Returns the number of lines walked.
+//
+// One pass finds commas and newlines together (DelimiterCursor). Fields
+// match SplitCSV on the trimmed line: a trailing comma adds no empty field.
+template <typename Visit>
+int ForEachCSVLine(string_view text, Visit visit) {
+    DelimiterCursor delimiters(Scanner(), text);
+    vector<string_view> tokens;
+    const char* next = text.data();
+    const char* end = next + text.size();
+    int lineNumber = 0;
+    while (next != end) {
+        lineNumber++;
+        tokens.clear();
+        const char* delimiter;
+        do {
+            delimiter = delimiters.Next();
+            tokens.push_back(TrimView(string_view(next, static_cast<size_t>(delimiter - next))));
+            next = delimiter == end ? end : delimiter + 1;
+        } while (delimiter != end && *delimiter == ',');
+
+        if (tokens.back().empty()) {
+            if (tokens.size() == 1) continue;  // blank line
+            tokens.pop_back();
+        }
+        visit(lineNumber, static_cast<const vector<string_view>&>(tokens));
+    }
+    return lineNumber;
+}
+
+// Cuts text into pieces of about chunkBytes that each end just after a
+// newline (the last ends where text does), so every line lies wholly in
+// one piece
+vector<string_view> SplitAtNewlines(string_view text, size_t chunkBytes) {
+    vector<string_view> chunks;
+    while (!text.empty()) {
+        size_t end = text.size();
+        if (chunkBytes < text.size()) {
+            size_t newline = text.find('\n', chunkBytes - 1);
+            if (newline != string_view::npos) end = newline + 1;
+        }
+        chunks.push_back(text.substr(0, end));
+        text.remove_prefix(end);
+    }
+    return chunks;
+}
+
+// Read-only memory mapping of a whole file, so a loader can tokenize the
+// contents in place instead of copying them through a stream line by line
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        Close();
+    }
+
+    // Maps filename; returns false if it cannot be opened or mapped. An
+    // empty file maps to an empty view.
+    bool Open(const string& filename) {
+        Close();
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize;
+        bool mapped = false;
+        if (GetFileSizeEx(file, &fileSize)) {
+            if (fileSize.QuadPart == 0) {
+                mapped = true;
+            }
+            else if (HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) {
+                data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                size = data != nullptr ? static_cast<size_t>(fileSize.QuadPart) : 0;
+                mapped = data != nullptr;
+                CloseHandle(mapping);  // the view keeps the mapping alive
+            }
+        }
+        CloseHandle(file);
+        return mapped;
+#else
+        int descriptor = open(filename.c_str(), O_RDONLY);
+        if (descriptor < 0) return false;
+
+        struct stat info;
+        bool mapped = false;
+        if (fstat(descriptor, &info) == 0 && S_ISREG(info.st_mode)) {
+            if (info.st_size == 0) {
+                mapped = true;
+            }
+            else {
+                void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+                if (view != MAP_FAILED) {
+                    madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+                    data = static_cast<const char*>(view);
+                    size = static_cast<size_t>(info.st_size);
+                    mapped = true;
+                }
+            }
+        }
+        close(descriptor);  // the mapping stays valid without it
+        return mapped;
+#endif
+    }
+
+    void Close() {
+        if (data != nullptr) {
+#if defined(_WIN32)
+            UnmapViewOfFile(data);
+#else
+            munmap(const_cast<char*>(data), size);
+#endif
+        }
+        data = nullptr;
+        size = 0;
+    }
+
+    // The file's contents, valid until Close
+    string_view View() const {
+        return string_view(data, size);
+    }
+};
+
+// ===============================
+// HASHING HELPERS
+// ===============================
+
+// 64-bit finalizer; a bijection, so distinct inputs never collide
+constexpr uint64_t Mix64(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBULL;
+    value ^= value >> 31;
+    return value;
+}
+
+// Position in [0, n) that a key lands on under a given perfect-hash pilot
+constexpr size_t PerfectHashPosition(uint64_t hashValue, uint64_t seed, uint32_t pilot, size_t n) {
+    return static_cast<size_t>(((Mix64(hashValue ^ Mix64(seed + pilot)) & 0xFFFFFFFFULL) * n) >> 32);
+}
+
+// Pilot bucket of a hash: its top 32 bits scaled onto bucketCount pilots
+constexpr size_t PerfectHashBucket(uint64_t hashValue, size_t bucketCount) {
+    return static_cast<size_t>(((hashValue >> 32) * bucketCount) >> 32);
+}
+
+// Chooses a pilot for every bucket so the n keys land on n distinct
+// positions. Buckets are placed largest first, while most positions are
+// still free. Returns false if some bucket cannot be placed, in which
+// case the caller retries with another seed.
+bool BuildPerfectHashPilots(const vector<uint64_t>& hashes, uint64_t seed, vector<uint32_t>& pilots,
+                            vector<size_t>& positions) {
+    size_t n = hashes.size();
+    size_t bucketCount = pilots.size();
+
+    // Group key indices by bucket (counting sort)
+    vector<size_t> bucketStart(bucketCount + 1, 0);
+    for (uint64_t hashValue : hashes) {
+        ++bucketStart[PerfectHashBucket(hashValue, bucketCount) + 1];
+    }
+    partial_sum(bucketStart.begin(), bucketStart.end(), bucketStart.begin());
+    vector<size_t> members(n);
+    vector<size_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        members[fill[PerfectHashBucket(hashes[i], bucketCount)]++] = i;
+    }
+
+    vector<size_t> order(bucketCount);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+        });
+
+    // The last singletons may need about n attempts to find the final
+    // free positions, so the pilot range scales with the catalog
+    uint64_t maxPilot = min<uint64_t>(0xFFFFFFFFULL, max<uint64_t>(65536, 64 * static_cast<uint64_t>(n)));
+    vector<bool> taken(n, false);
+    vector<size_t> trial;
+
+    for (size_t bucket : order) {
+        size_t begin = bucketStart[bucket];
+        size_t end = bucketStart[bucket + 1];
+        if (begin == end) break;  // only empty buckets remain
+
+        bool placed = false;
+        for (uint64_t pilot = 0; pilot < maxPilot && !placed; ++pilot) {
+            trial.clear();
+            for (size_t k = begin; k < end; ++k) {
+                size_t position = PerfectHashPosition(hashes[members[k]], seed, static_cast<uint32_t>(pilot), n);
+                if (taken[position] || find(trial.begin(), trial.end(), position) != trial.end()) break;
+                trial.push_back(position);
+            }
+            if (trial.size() != end - begin) continue;
+
+            for (size_t k = begin; k < end; ++k) {
+                taken[trial[k - begin]] = true;
+                positions[members[k]] = trial[k - begin];
+            }
+            pilots[bucket] = static_cast<uint32_t>(pilot);
+            placed = true;
+        }
+        if (!placed) return false;
+    }
+    return true;
+}
+
+// Finds a minimal perfect hash of hashes: the seed, one pilot per bucket of
+// about keysPerPilot keys, and the position of every key. A few seeds almost
+// always suffice; if they do not, smaller buckets are easier to place, down
+// to one key per pilot. Returns false if even that fails.
+bool FindPerfectHash(const vector<uint64_t>& hashes, size_t keysPerPilot, uint64_t& seed,
+                     vector<uint32_t>& pilots, vector<size_t>& positions) {
+    static constexpr uint64_t kSeedsPerPilotCount = 16;
+
+    size_t n = hashes.size();
+    size_t pilotCount = max<size_t>(1, (n + keysPerPilot - 1) / keysPerPilot);
+    positions.assign(n, 0);
+    for (;;) {
+        for (seed = 0; seed < kSeedsPerPilotCount; ++seed) {
+            pilots.assign(pilotCount, 0);
+            if (BuildPerfectHashPilots(hashes, seed, pilots, positions)) {
+                return true;
+            }
+        }
+        if (pilotCount >= n) return false;
+        pilotCount = min(n, pilotCount * 2);
+    }
+}
+
+// High and low halves of the 128-bit product a * b, folded together
+inline uint64_t MultiplyFold(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    uint64_t low = _umul128(a, b, &high);
+    return low ^ high;
+#else
+    uint64_t aLow = a & 0xFFFFFFFFULL, aHigh = a >> 32;
+    uint64_t bLow = b & 0xFFFFFFFFULL, bHigh = b >> 32;
+    uint64_t lowLow = aLow * bLow, lowHigh = aLow * bHigh;
+    uint64_t highLow = aHigh * bLow, highHigh = aHigh * bHigh;
+    uint64_t middle = (lowLow >> 32) + (lowHigh & 0xFFFFFFFFULL) + (highLow & 0xFFFFFFFFULL);
+    uint64_t low = (middle << 32) | (lowLow & 0xFFFFFFFFULL);
+    uint64_t high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+    return low ^ high;
+#endif
+}
+
+// Hash policies for BasicHashTable. Each maps a CourseKey to a 64-bit hash;
+// equal course numbers always have equal key codes, so hashing the code is
+// enough. The table takes the group index from bits 7 and up (masked to a
+// power of two) and the control-byte fingerprint from the low 7 bits.
+
+// The original polynomial hash (hash * 31 + character) over the characters
+// of a packed course number, or over the bytes of an interned key's code
+struct PolynomialHasher {
+    static const char* Name() { return "polynomial*31"; }
+    static uint64_t Hash(CourseKey key) {
+        uint64_t hashValue = 0;
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            uint64_t c = (key.Code() >> shift) & 0xFF;
+            if (c == 0 && key.IsPacked()) break;
+            hashValue = hashValue * 31 + c;
+        }
+        return hashValue;
+    }
+};
+
+// FNV-1a over the eight bytes of the key code
+struct Fnv1aHasher {
+    static const char* Name() { return "FNV-1a"; }
+    static uint64_t Hash(CourseKey key) {
+        uint64_t hashValue = 0xCBF29CE484222325ULL;
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            hashValue ^= (key.Code() >> shift) & 0xFF;
+            hashValue *= 0x100000001B3ULL;
+        }
+        return hashValue;
+    }
+};
+
+// splitmix64 finalizer applied to the key code (the default)
+struct SplitMixHasher {
+    static const char* Name() { return "splitmix64"; }
+    static uint64_t Hash(CourseKey key) {
+        return Mix64(key.Code());
+    }
+};
+
+// wyhash-style mixer: one 64x64->128-bit multiply, folded
+struct WyMixHasher {
+    static const char* Name() { return "wymix"; }
+    static uint64_t Hash(CourseKey key) {
+        return MultiplyFold(key.Code() ^ 0xA0761D6478BD642FULL, 0xE7037ED1A0B428DBULL);
+    }
+};
+
+// SipHash-2-4 of the key code under a random key drawn once per process.
+// The unseeded hashers above are fixed functions, so anyone can search
+// offline for course numbers that share a probe sequence and send them to
+// degrade Insert and Search to O(n). Without the process key those
+// collisions cannot be predicted. Use it (HardenedHashTable) wherever course
+// numbers come from untrusted callers.
+struct SipHasher {
+    struct Key {
+        uint64_t k0;
+        uint64_t k1;
+    };
+
+    static const char* Name() { return "siphash-2-4"; }
+
+    static const Key& ProcessKey() {
+        static const Key key = [] {
+            random_device device;
+            uint64_t clock = static_cast<uint64_t>(chrono::steady_clock::now().time_since_epoch().count());
+            Key k;
+            k.k0 = (static_cast<uint64_t>(device()) << 32 | device()) ^ Mix64(clock);
+            k.k1 = (static_cast<uint64_t>(device()) << 32 | device()) ^ Mix64(clock + 1);
+            return k;
+        }();
+        return key;
+    }
+
+    static uint64_t Hash(CourseKey key) {
+        const Key& k = ProcessKey();
+        uint64_t v0 = k.k0 ^ 0x736F6D6570736575ULL;
+        uint64_t v1 = k.k1 ^ 0x646F72616E646F6DULL;
+        uint64_t v2 = k.k0 ^ 0x6C7967656E657261ULL;
+        uint64_t v3 = k.k1 ^ 0x7465646279746573ULL;
+
+        // One 8-byte message block, then the length block, then finalization
+        uint64_t blocks[2] = { key.Code(), 8ULL << 56 };
+        for (uint64_t m : blocks) {
+            v3 ^= m;
+            Round(v0, v1, v2, v3);
+            Round(v0, v1, v2, v3);
+            v0 ^= m;
+        }
+        v2 ^= 0xFF;
+        for (int i = 0; i < 4; ++i) {
+            Round(v0, v1, v2, v3);
+        }
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+
+private:
+    static uint64_t Rotate(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    static void Round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+        v0 += v1; v1 = Rotate(v1, 13); v1 ^= v0; v0 = Rotate(v0, 32);
+        v2 += v3; v3 = Rotate(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = Rotate(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = Rotate(v1, 17); v1 ^= v2; v2 = Rotate(v2, 32);
+    }
+};
+
+// ===============================
+// COURSE TITLES
+// ===============================
+
+// Process-wide directory from title ID to title record, read without a
+// lock. Pools assign IDs as they store titles and release them when they
+// are destroyed, and released IDs are handed out again, so the directory
+// grows only with the titles alive at once. ID 0 is the empty title.
+class TitleIdDirectory {
+public:
+    // The record of a live title ID
+    const char* Record(uint32_t id) const {
+        return records.Load(id);
+    }
+
+    uint32_t Assign(const char* record) {
+        lock_guard<mutex> guard(lock);
+        uint32_t id = nextId;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        else {
+            ++nextId;
+        }
+        records.Store(id, record);
+        return id;
+    }
+
+    void Release(const vector<uint32_t>& ids) {
+        lock_guard<mutex> guard(lock);
+        for (uint32_t id : ids) {
+            records.Store(id, nullptr);
+            freeIds.push_back(id);
+        }
+    }
+
+private:
+    mutex lock;  // serializes Assign and Release
+    StableDirectory<char> records;
+    vector<uint32_t> freeIds;
+    uint32_t nextId = 1;
+};
+
+static TitleIdDirectory& TitleIds() {
+    static TitleIdDirectory directory;
+    return directory;
+}
+
+// Interning pool behind CourseTitle. Each title is stored once, as a
+// 4-byte length followed by its text, in 64 KB blocks that are never moved
+// or freed while the pool lives, and gets an ID in the TitleIdDirectory,
+// so reading a title needs neither the pool's lock nor its index. The
+// dedupe index is an open-addressing table of IDs (4 bytes a slot) that
+// compares through the stored text, rather than a map holding a second
+// copy of every key.
+//
+// Every catalog store owns a pool, shared with its copies, and a load
+// interns into the pool of the store it fills (see TitleScope), so a
+// reloaded catalog's titles and their IDs are freed along with the last
+// copy of it.
+class TitlePool {
+private:
+    static constexpr size_t kBlockSize = 64 * 1024;
+    static constexpr size_t kInitialSlots = 1024;
+
+    TitleIdDirectory& ids;  // outlives every pool
+    mutable mutex lock;     // serializes Intern; reading a title never takes it
+    vector<unique_ptr<char[]>> blocks;
+    size_t blockUsed = kBlockSize;
+    size_t blockBytes = 0;
+    size_t count = 0;
+    vector<uint32_t> index;  // title ID per slot, 0 when empty; built on first use
+
+    static uint64_t HashText(string_view text) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (char c : text) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+        }
+        return Mix64(hash);
+    }
+
+    // Slot holding text, or the empty slot where it belongs
+    size_t FindSlot(string_view text) const {
+        size_t mask = index.size() - 1;
+        for (size_t slot = static_cast<size_t>(HashText(text)) & mask; ; slot = (slot + 1) & mask) {
+            if (index[slot] == 0 || TextOf(ids.Record(index[slot])) == text) return slot;
+        }
+    }
+
+    // Copies text and its length into the current block, starting a new
+    // block when full
+    const char* Store(string_view text) {
+        uint32_t length = static_cast<uint32_t>(text.size());
+        size_t recordSize = sizeof(length) + text.size();
+        if (recordSize > kBlockSize - blockUsed) {
+            size_t size = max(kBlockSize, recordSize);
+            blocks.push_back(make_unique<char[]>(size));
+            blockBytes += size;
+            blockUsed = 0;
+        }
+        char* start = blocks.back().get() + blockUsed;
+        memcpy(start, &length, sizeof(length));
+        copy(text.begin(), text.end(), start + sizeof(length));
+        blockUsed = min(kBlockSize, blockUsed + recordSize);  // an oversized title fills its block
+        return start;
+    }
+
+public:
+    TitlePool() : ids(TitleIds()) {}
+
+    ~TitlePool() {
+        vector<uint32_t> stored;
+        for (uint32_t id : index) {
+            if (id != 0) stored.push_back(id);
+        }
+        ids.Release(stored);
+    }
+
+    TitlePool(const TitlePool&) = delete;
+    TitlePool& operator=(const TitlePool&) = delete;
+
+    // Text of a title record
+    static string_view TextOf(const char* record) {
+        uint32_t length;
+        memcpy(&length, record, sizeof(length));
+        return string_view(record + sizeof(length), length);
+    }
+
+    // Returns the ID of text (0 for the empty title), storing it if new
+    uint32_t Intern(string_view text) {
+        if (text.empty()) return 0;
+
+        lock_guard<mutex> guard(lock);
+        if (index.empty()) {
+            index.assign(kInitialSlots, 0);
+        }
+        size_t slot = FindSlot(text);
+        if (index[slot] != 0) {
+            return index[slot];
+        }
+
+        uint32_t id = ids.Assign(Store(text));
+        index[slot] = id;
+        ++count;
+
+        // Keep the index at most half full
+        if (count * 2 > index.size()) {
+            vector<uint32_t> previous(index.size() * 2, 0);
+            previous.swap(index);
+            for (uint32_t entry : previous) {
+                if (entry != 0) index[FindSlot(TextOf(ids.Record(entry)))] = entry;
+            }
+        }
+        return id;
+    }
+
+    // Distinct titles and the bytes the pool holds for them, counting its
+    // entries in the ID directory
+    size_t Count() const {
+        lock_guard<mutex> guard(lock);
+        return count;
+    }
+
+    size_t BytesUsed() const {
+        lock_guard<mutex> guard(lock);
+        return blockBytes + index.capacity() * sizeof(uint32_t) + count * sizeof(const char*);
+    }
+};
+
+// Pool that CourseTitle::FromString interns into on this thread; null
+// outside any TitleScope
+static thread_local TitlePool* currentTitlePool = nullptr;
+
+// Makes pool the current title pool of this thread until the scope ends.
+// A load opens one on every thread that parses courses for its store.
+class TitleScope {
+public:
+    explicit TitleScope(TitlePool* pool) : previous(currentTitlePool) {
+        currentTitlePool = pool;
+    }
+    ~TitleScope() {
+        currentTitlePool = previous;
+    }
+
+    TitleScope(const TitleScope&) = delete;
+    TitleScope& operator=(const TitleScope&) = delete;
+
+private:
+    TitlePool* previous;
+};
+
+// Every title belongs to a pool whose owner decides when it is freed, so
+// there is no process-wide fallback to intern into
+CourseTitle CourseTitle::FromString(string_view title) {
+    if (currentTitlePool == nullptr) {
+        throw logic_error("CourseTitle::FromString called outside any TitleScope");
+    }
+    return CourseTitle(currentTitlePool->Intern(title));
+}
+
+string_view CourseTitle::View() const {
+    return id == 0 ? string_view() : TitlePool::TextOf(TitleIds().Record(id));
+}
+
+ostream& operator<<(ostream& out, CourseTitle title) {
+    return out << title.View();
+}
+
+// ===============================
+// CATALOG ARENA
+// ===============================
+
+// Monotonic memory resource for everything one loaded catalog allocates.
+// Small requests (prerequisite lists, tree nodes) are bump-allocated from
+// 64 KB chunks and never freed one at a time. Large requests (slot arrays,
+// vector buffers) go straight to the heap and are freed normally, so a
+// table that grows does not strand its old arrays in the arena. Release
+// hands back every chunk and every large block still held at once.
+class CatalogArena : public pmr::memory_resource {
+private:
+    static constexpr size_t kChunkSize = 64 * 1024;
+    static constexpr size_t kLargeRequest = kChunkSize / 4;
+
+    struct LargeBlock {
+        size_t bytes;
+        size_t alignment;
+    };
+
+    vector<void*> chunks;
+    unordered_map<void*, LargeBlock> largeBlocks;
+    char* cursor = nullptr;
+    size_t remaining = 0;
+    size_t smallBytes = 0;   // handed out from chunks since the last Release
+    size_t freedBytes = 0;   // ...of which given back, but not reusable
+    size_t largeBytes = 0;   // large requests currently live
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (bytes >= kLargeRequest) {
+            void* block = pmr::new_delete_resource()->allocate(bytes, alignment);
+            largeBlocks.emplace(block, LargeBlock{ bytes, alignment });
+            largeBytes += bytes;
+            return block;
+        }
+
+        size_t padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+        if (cursor == nullptr || padding + bytes > remaining) {
+            chunks.push_back(::operator new(kChunkSize));
+            cursor = static_cast<char*>(chunks.back());
+            remaining = kChunkSize;
+            padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+        }
+
+        void* result = cursor + padding;
+        cursor += padding + bytes;
+        remaining -= padding + bytes;
+        smallBytes += bytes;
+        return result;
+    }
+
+    // Small blocks are reclaimed only by Release
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+        if (bytes >= kLargeRequest) {
+            largeBlocks.erase(pointer);
+            largeBytes -= bytes;
+            pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+        }
+        else {
+            freedBytes += bytes;
+        }
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    CatalogArena() = default;
+    CatalogArena(const CatalogArena&) = delete;
+    CatalogArena& operator=(const CatalogArena&) = delete;
+
+    ~CatalogArena() override {
+        Release();
+    }
+
+    // Frees every chunk and large block. Containers that used the arena
+    // must already be empty, destroyed or abandoned (see CourseSlots).
+    void Release() {
+        for (void* chunk : chunks) {
+            ::operator delete(chunk);
+        }
+        for (const auto& block : largeBlocks) {
+            pmr::new_delete_resource()->deallocate(block.first, block.second.bytes, block.second.alignment);
+        }
+        chunks.clear();
+        largeBlocks.clear();
+        largeBytes = 0;
+        cursor = nullptr;
+        remaining = 0;
+        smallBytes = 0;
+        freedBytes = 0;
+    }
+
+    size_t ChunkBytes() const { return chunks.size() * kChunkSize; }
+    size_t SmallBytes() const { return smallBytes - freedBytes; }  // small blocks in use
+    size_t LargeBytes() const { return largeBytes; }
+
+    // Chunk space not holding a live block: freed blocks, alignment padding
+    // and the unused tail of the current chunk
+    size_t SlackBytes() const { return ChunkBytes() - SmallBytes(); }
+};
+
+// A course holds nothing but its prerequisite buffer, and a course built
+// with an arena's allocator takes that buffer from the arena. Release
+// reclaims every block, so a table whose courses the arena owns may drop
+// them without running ~Course: clearing it costs no pass over the slots.
+static_assert(is_trivially_destructible<CourseKey>::value && is_trivially_destructible<CourseTitle>::value,
+    "a Course must own nothing outside its prerequisite list");
+
+// Storage for a fixed number of courses in a CatalogArena. Slots start
+// raw; the owner builds courses in them with Construct and tracks which are
+// live. Freeing the storage never destroys a course, so courses still in it
+// must have been moved out or be left for the arena's next Release.
+class CourseSlots {
+public:
+    explicit CourseSlots(CatalogArena* arena) : arena(arena) {}
+    ~CourseSlots() { Free(); }
+
+    CourseSlots(const CourseSlots&) = delete;
+    CourseSlots& operator=(const CourseSlots&) = delete;
+
+    // Replaces the storage with slotCount raw slots
+    void Allocate(size_t slotCount) {
+        Free();
+        if (slotCount > 0) {
+            data = static_cast<Course*>(arena->allocate(slotCount * sizeof(Course), alignof(Course)));
+        }
+        count = slotCount;
+    }
+
+    // Builds a course in a raw slot, with its prerequisites in the arena
+    template <typename CourseRef>
+    Course& Construct(size_t slot, CourseRef&& course) {
+        return *new (&data[slot]) Course(std::forward<CourseRef>(course), Course::allocator_type(arena));
+    }
+
+    // Forgets the storage and its courses without freeing either, for an
+    // arena about to be released
+    void Abandon() {
+        data = nullptr;
+        count = 0;
+    }
+
+    // Both sides must use the same arena
+    void swap(CourseSlots& other) {
+        std::swap(data, other.data);
+        std::swap(count, other.count);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    Course& operator[](size_t slot) { return data[slot]; }
+    const Course& operator[](size_t slot) const { return data[slot]; }
+    Course* begin() { return data; }
+    Course* end() { return data + count; }
+    const Course* begin() const { return data; }
+    const Course* end() const { return data + count; }
+
+private:
+    void Free() {
+        if (data != nullptr) {
+            arena->deallocate(data, count * sizeof(Course), alignof(Course));
+        }
+        data = nullptr;
+        count = 0;
+    }
+
+    CatalogArena* arena;
+    Course* data = nullptr;
+    size_t count = 0;
+};
+
+// ===============================
+// MEMORY ACCOUNTING
+// ===============================
+
+// Bytes held by a loaded catalog, by what they are spent on. Course-number
+// strings live in a process-wide pool shared by every catalog and titles in
+// the catalog's own pool, so stores leave those two at 0 and the report
+// adds them once.
+struct MemoryUsage {
+    size_t courseRecords = 0;   // the Course objects themselves
+    size_t bucketArray = 0;     // empty slots, control bytes, unused capacity
+    size_t nodeOverhead = 0;    // tree links and node headers, directories
+    size_t prerequisites = 0;   // prerequisite lists too long to stay inline
+    size_t indexes = 0;         // ordered key index, prefix trie, Bloom filter
+    size_t allocatorSlack = 0;  // arena space not holding a live block
+    size_t keyStrings = 0;      // interned course numbers over 8 characters
+    size_t titles = 0;          // interned title text and its dedupe index
+
+    size_t Total() const {
+        return courseRecords + bucketArray + nodeOverhead + prerequisites + indexes + allocatorSlack
+            + keyStrings + titles;
+    }
+
+    MemoryUsage& operator+=(const MemoryUsage& other) {
+        courseRecords += other.courseRecords;
+        bucketArray += other.bucketArray;
+        nodeOverhead += other.nodeOverhead;
+        prerequisites += other.prerequisites;
+        indexes += other.indexes;
+        allocatorSlack += other.allocatorSlack;
+        keyStrings += other.keyStrings;
+        titles += other.titles;
+        return *this;
+    }
+};
+
+// ===============================
+// BLOOM FILTER CLASS
+// ===============================
+
+// Blocked Bloom filter over 64-bit key hashes. All probe bits of a key lie in
+// one 64-byte block, so answering "definitely not stored" costs a single
+// cache line. Used in front of HashTable::Search to turn away mistyped and
+// retired course numbers cheaply.
+class BlockedBloomFilter {
+private:
+    static constexpr uint32_t kBlockBits = 512;
+
+    struct alignas(64) Block {
+        uint64_t words[kBlockBits / 64];
+    };
+
+    vector<Block> blocks;
+    uint32_t probes;   // bits set per key
+
+    size_t BlockIndex(uint64_t mixed) const {
+        return static_cast<size_t>(((mixed >> 32) * blocks.size()) >> 32);
+    }
+
+    // Double hashing inside the block: probe i uses the top 9 bits of a + i*b
+    template <typename Visit>
+    void ForEachBit(uint64_t mixed, Visit visit) const {
+        uint32_t a = static_cast<uint32_t>(mixed);
+        uint32_t b = static_cast<uint32_t>(Mix64(mixed) >> 32) | 1u;
+        for (uint32_t i = 0; i < probes; ++i) {
+            visit((a + i * b) >> 23);
+        }
+    }
+
+public:
+    BlockedBloomFilter() : probes(0) {}
+
+    // Sizes the filter for expectedKeys at the requested false-positive rate
+    // (0 < rate < 1) and empties it
+    void Reset(size_t expectedKeys, double falsePositiveRate) {
+        // Optimal bits per key for a classic filter, plus ~20% for blocking
+        double bitsPerKey = 1.2 * -log(falsePositiveRate) / (log(2.0) * log(2.0));
+        probes = static_cast<uint32_t>(min(16.0, max(1.0, round(bitsPerKey * log(2.0)))));
+        size_t bits = static_cast<size_t>(ceil(max<size_t>(1, expectedKeys) * bitsPerKey));
+        blocks.assign((bits + kBlockBits - 1) / kBlockBits, Block());
+    }
+
+    void Add(uint64_t hashValue) {
+        uint64_t mixed = Mix64(hashValue);
+        Block& block = blocks[BlockIndex(mixed)];
+        ForEachBit(mixed, [&](uint32_t bit) {
+            block.words[bit / 64] |= 1ULL << (bit % 64);
+            });
+    }
+
+    // False means the key was never added; true means it probably was
+    bool MayContain(uint64_t hashValue) const {
+        uint64_t mixed = Mix64(hashValue);
+        const Block& block = blocks[BlockIndex(mixed)];
+        bool present = true;
+        ForEachBit(mixed, [&](uint32_t bit) {
+            present = present && (block.words[bit / 64] >> (bit % 64) & 1) != 0;
+            });
+        return present;
+    }
+
+    bool Empty() const {
+        return blocks.empty();
+    }
+
+    size_t BitCount() const {
+        return blocks.size() * kBlockBits;
+    }
+
+    uint32_t ProbeCount() const {
+        return probes;
+    }
+};
+
+// Counters for lookups answered with a negative-lookup filter in place
+struct LookupStatistics {
+    uint64_t rejectedByFilter = 0;   // misses answered by the filter alone
+    uint64_t passedFilter = 0;       // lookups that went on to the table
+    uint64_t falsePositives = 0;     // ...and then found nothing
+};
+
+// ===============================
+// PREFIX INDEX CLASS
+// ===============================
+
+// Radix trie over course numbers for prefix queries such as "CSCI2*". The
+// courses are kept sorted, and every trie node records the run of sorted
+// courses below it, so a query walks the prefix once and then reads its
+// matches straight out of one contiguous range. Single-child chains are
+// collapsed into one node whose label is stored in a shared character pool.
+// The index holds pointers into the owning table, which must rebuild it
+// whenever those courses move.
+class PrefixIndex {
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFF;
+
+    struct Node {
+        uint32_t begin;        // first course under this node
+        uint32_t end;          // one past the last course under this node
+        uint32_t labelOffset;  // edge label from the parent, in labels
+        uint32_t labelLength;
+        uint32_t firstChild;
+        uint32_t nextSibling;
+    };
+
+    vector<const Course*> sorted;
+    vector<Node> nodes;
+    string labels;
+
+    // Adds the children of a node covering names[begin, end), all of which
+    // share their first depth characters
+    void BuildChildren(uint32_t parent, const vector<string>& names, uint32_t begin, uint32_t end, size_t depth) {
+        uint32_t previous = kNone;
+        uint32_t i = begin;
+        while (i < end && names[i].size() == depth) {
+            ++i;  // ends exactly here; shorter names sort first
+        }
+
+        while (i < end) {
+            uint32_t j = i + 1;
+            while (j < end && names[j][depth] == names[i][depth]) {
+                ++j;
+            }
+
+            // In sorted order the first and last names bound the shared prefix
+            const string& first = names[i];
+            const string& last = names[j - 1];
+            size_t childDepth = depth + 1;
+            while (childDepth < first.size() && childDepth < last.size() && first[childDepth] == last[childDepth]) {
+                ++childDepth;
+            }
+
+            Node child;
+            child.begin = i;
+            child.end = j;
+            child.labelOffset = static_cast<uint32_t>(labels.size());
+            child.labelLength = static_cast<uint32_t>(childDepth - depth);
+            child.firstChild = kNone;
+            child.nextSibling = kNone;
+            labels.append(first, depth, childDepth - depth);
+
+            uint32_t index = static_cast<uint32_t>(nodes.size());
+            nodes.push_back(child);
+            if (previous == kNone) {
+                nodes[parent].firstChild = index;
+            }
+            else {
+                nodes[previous].nextSibling = index;
+            }
+            previous = index;
+
+            BuildChildren(index, names, i, j, childDepth);
+            i = j;
+        }
+    }
+
+public:
+    // Indexes the given courses, replacing any previous contents
+    void Build(vector<const Course*> courses) {
+        auto byNumber = [](const Course* a, const Course* b) {
+            return a->courseNumber < b->courseNumber;
+        };
+        if (!is_sorted(courses.begin(), courses.end(), byNumber)) {
+            sort(courses.begin(), courses.end(), byNumber);
+        }
+        sorted = std::move(courses);
+
+        vector<string> names;
+        names.reserve(sorted.size());
+        for (const Course* course : sorted) {
+            names.push_back(course->courseNumber.ToString());
+        }
+
+        nodes.clear();
+        labels.clear();
+        nodes.push_back(Node{ 0, static_cast<uint32_t>(sorted.size()), 0, 0, kNone, kNone });
+        BuildChildren(0, names, 0, static_cast<uint32_t>(sorted.size()), 0);
+    }
+
+    void Clear() {
+        vector<const Course*>().swap(sorted);
+        vector<Node>().swap(nodes);
+        string().swap(labels);
+    }
+
+    // True once Build has run (even over an empty catalog)
+    bool IsBuilt() const {
+        return !nodes.empty();
+    }
+
+    size_t BytesUsed() const {
+        return sorted.capacity() * sizeof(const Course*) + nodes.capacity() * sizeof(Node) + labels.capacity();
+    }
+
+    // Calls visit(course) for every course whose number starts with prefix
+    // (already normalized), in course-number order. Returns the match count.
+    template <typename Visitor>
+    size_t FindByPrefix(string_view prefix, Visitor visit) const {
+        if (nodes.empty()) return 0;
+
+        uint32_t node = 0;
+        size_t depth = 0;
+        while (depth < prefix.size()) {
+            uint32_t child = nodes[node].firstChild;
+            while (child != kNone && labels[nodes[child].labelOffset] != prefix[depth]) {
+                child = nodes[child].nextSibling;
+            }
+            if (child == kNone) return 0;
+
+            // The prefix may end partway along the child's label
+            string_view label(labels.data() + nodes[child].labelOffset, nodes[child].labelLength);
+            size_t compared = min(label.size(), prefix.size() - depth);
+            if (label.compare(0, compared, prefix.substr(depth, compared)) != 0) return 0;
+
+            node = child;
+            depth += compared;
+        }
+
+        for (uint32_t i = nodes[node].begin; i < nodes[node].end; ++i) {
+            visit(*sorted[i]);
+        }
+        return nodes[node].end - nodes[node].begin;
+    }
+};
+
+// ===============================
+// HASH TABLE CLASS
+// ===============================
+
+// Hasher is one of the hash policies above; HashTable uses the default.
+template <typename Hasher = SplitMixHasher>
+class BasicHashTable {
+private:
+    // Control byte values. A full slot stores the low 7 bits of its hash
+    // (always >= 0) and an empty slot holds kEmpty, so a single signed
+    // compare tells the two states apart.
+    static constexpr signed char kEmpty = -128;
+    static constexpr size_t kGroupWidth = 16;
+
+    // Growth starts once the table is 7/8 full; each later Insert then moves
+    // this many groups out of the old array, so the old array is always
+    // drained long before the new one reaches the threshold again.
+    static constexpr size_t kMaxLoadNumerator = 7;
+    static constexpr size_t kMaxLoadDenominator = 8;
+    static constexpr size_t kMigrateGroupsPerInsert = 2;
+
+    // Average number of keys sharing one pilot in frozen mode
+    static constexpr size_t kKeysPerPilot = 4;
+
+    // Open addressing: every course lives directly in one contiguous slot
+    // array, and a parallel array of one-byte control tags is probed a whole
+    // group (16 slots) at a time. A lookup usually touches a single control
+    // group and a single slot instead of chasing list nodes.
+    // The slots are raw storage: a course is constructed in a slot only when
+    // its control byte is set, so allocating a larger array costs no more
+    // than clearing its control bytes.
+    struct SlotArray {
+        explicit SlotArray(pmr::memory_resource* resource) : resource(resource) {}
+
+        pmr::memory_resource* resource;
+        vector<signed char> control;
+        Course* slots = nullptr;
+        size_t size = 0;   // number of slots, a power-of-two multiple of kGroupWidth
+    };
+
+    // Backs the slot arrays, the frozen array and every course's
+    // prerequisite list, so Clear and the destructor release a whole catalog
+    // at once without destroying courses one by one. Declared before the
+    // arrays so it outlives them.
+    CatalogArena arena;
+
+    SlotArray active;     // receives all new courses
+    SlotArray draining;   // previous array while an incremental rehash runs
+    size_t drainCursor;   // next slot of draining still to be migrated
+    size_t count;         // number of stored courses across both arrays
+
+    // Frozen mode: the courses sit densely in perfect-hash order and each
+    // bucket of keys has a pilot value chosen at build time so that every
+    // key maps to its own position (a hash-and-displace minimal perfect hash)
+    CourseSlots frozen;
+    vector<uint32_t> pilots;
+    uint64_t pilotSeed;
+    bool isFrozen;
+
+    // Optional negative-lookup filter consulted before any probe. Inserts
+    // past the size it was built for rebuild it with room to double.
+    BlockedBloomFilter filter;
+    double filterRate;
+    size_t filterCapacity;
+    mutable atomic<uint64_t> rejectedByFilter;
+    mutable atomic<uint64_t> passedFilter;
+    mutable atomic<uint64_t> falsePositives;
+
+    // Built on request once loading is done; dropped by anything that
+    // moves stored courses
+    PrefixIndex prefixIndex;
+
+    // Every stored key in course-number order, so listings need no sort.
+    // ordered[0, sortedKeys) is sorted; newer keys are appended after it and
+    // merged in once they outnumber half the sorted run, so an insert costs
+    // amortized O(log n). Between BeginBulkLoad and EndBulkLoad they are
+    // only appended, and EndBulkLoad merges them once.
+    vector<CourseKey> ordered;
+    size_t sortedKeys;
+    bool bulkLoading;
+
+    // Hash function — delegates to the Hasher policy
+    static uint64_t Hash(CourseKey key) {
+        return Hasher::Hash(key);
+    }
+
+    // Smallest slot array that holds the given number of courses below the
+    // maximum load factor
+    static size_t SlotCountFor(size_t courses) {
+        size_t slotCount = kGroupWidth;
+        while (slotCount * kMaxLoadNumerator < courses * kMaxLoadDenominator) {
+            slotCount *= 2;
+        }
+        return slotCount;
+    }
+
+    // Low 7 bits of the hash, kept in the control byte as a fingerprint
+    static signed char Fingerprint(uint64_t hashValue) {
+        return static_cast<signed char>(hashValue & 0x7F);
+    }
+
+    static void Allocate(SlotArray& array, size_t size) {
+        Release(array);
+        array.size = size;
+        array.control.assign(size, kEmpty);
+        array.slots = static_cast<Course*>(array.resource->allocate(size * sizeof(Course), alignof(Course)));
+    }
+
+    // Destroys the courses from firstLive on and frees the array's storage
+    static void Release(SlotArray& array, size_t firstLive = 0) {
+        for (size_t i = firstLive; i < array.size; ++i) {
+            if (array.control[i] != kEmpty) {
+                array.slots[i].~Course();
+            }
+        }
+        if (array.slots != nullptr) {
+            array.resource->deallocate(array.slots, array.size * sizeof(Course), alignof(Course));
+        }
+        array.slots = nullptr;
+        array.size = 0;
+        vector<signed char>().swap(array.control);
+    }
+
+    // Forgets an array's courses and storage without touching them, for an
+    // arena about to be released
+    static void Abandon(SlotArray& array) {
+        array.slots = nullptr;
+        array.size = 0;
+        vector<signed char>().swap(array.control);
+    }
+
+    // Constructs a course in an empty slot and marks the slot full
+    template <typename CourseRef>
+    static void Place(SlotArray& array, size_t slot, uint64_t hashValue, CourseRef&& course) {
+        new (&array.slots[slot]) Course(std::forward<CourseRef>(course), Course::allocator_type(array.resource));
+        array.control[slot] = Fingerprint(hashValue);
+    }
+
+    // First slot of an array that may still hold a live course. Slots of
+    // the draining array below drainCursor keep their control bytes (lookups
+    // must still probe past them) but their courses have moved to active
+    // and been destroyed.
+    size_t FirstLiveSlot(const SlotArray* array) const {
+        return array == &draining ? drainCursor : 0;
+    }
+
+    // Returns a bitmask with bit i set when control[group + i] == tag
+    static unsigned int MatchGroup(const SlotArray& array, size_t group, signed char tag) {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&array.control[group]));
+        return static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(tag))));
+#else
+        unsigned int mask = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i) {
+            if (array.control[group + i] == tag) mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    // Index of the lowest set bit in a non-zero group mask
+    static size_t LowestBit(unsigned int mask) {
+        size_t i = 0;
+        while ((mask & 1u) == 0) {
+            mask >>= 1;
+            ++i;
+        }
+        return i;
+    }
+
+    // Walks the probe sequence of one slot array for a key. Returns the slot
+    // index holding the key, or array.size when it is absent; in that case
+    // insertSlot receives the first empty slot seen. Slots below firstLive
+    // are probed past but never matched. groupsProbed, when given, receives
+    // the number of groups inspected.
+    static size_t FindSlot(const SlotArray& array, CourseKey key, uint64_t hashValue, size_t& insertSlot,
+                           size_t firstLive = 0, size_t* groupsProbed = nullptr) {
+        insertSlot = array.size;
+        if (array.size == 0) return array.size;
+
+        size_t groupCount = array.size / kGroupWidth;
+        size_t groupIndex = static_cast<size_t>(hashValue >> 7) & (groupCount - 1);
+        signed char tag = Fingerprint(hashValue);
+
+        // Triangular probing over groups visits every group exactly once
+        // when the group count is a power of two.
+        for (size_t step = 1; step <= groupCount; ++step) {
+            size_t group = groupIndex * kGroupWidth;
+            if (groupsProbed != nullptr) *groupsProbed = step;
+
+            for (unsigned int m = MatchGroup(array, group, tag); m != 0; m &= m - 1) {
+                size_t slot = group + LowestBit(m);
+                if (slot >= firstLive && array.slots[slot].courseNumber == key) {
+                    return slot;
+                }
+            }
+
+            unsigned int empties = MatchGroup(array, group, kEmpty);
+            if (empties != 0) {
+                insertSlot = group + LowestBit(empties);
+                return array.size;
+            }
+
+            groupIndex = (groupIndex + step) & (groupCount - 1);
+        }
+
+        return array.size;
+    }
+
+    // Moves up to kMigrateGroupsPerInsert groups from the draining array
+    // into the active one, releasing the old array once it is empty. The
+    // emptied slots stay marked full until then, so every walk over the
+    // draining array starts at FirstLiveSlot.
+    void MigrateSome() {
+        if (draining.size == 0) return;
+
+        size_t stop = min(draining.size, drainCursor + kMigrateGroupsPerInsert * kGroupWidth);
+        for (; drainCursor < stop; ++drainCursor) {
+            if (draining.control[drainCursor] == kEmpty) continue;
+
+            Course& course = draining.slots[drainCursor];
+            uint64_t hashValue = Hash(course.courseNumber);
+            size_t insertSlot = 0;
+            FindSlot(active, course.courseNumber, hashValue, insertSlot);
+            Place(active, insertSlot, hashValue, std::move(course));
+            course.~Course();
+        }
+
+        if (drainCursor == draining.size) {
+            Release(draining, drainCursor);
+            drainCursor = 0;
+        }
+    }
+
+    // Starts an incremental rehash into an array twice the current size.
+    // Existing courses stay where they are and move over a few groups at a
+    // time, so no single Insert pays for copying the whole table.
+    void BeginGrowth() {
+        // A rehash still in progress must finish before the next one starts
+        while (draining.size != 0) {
+            MigrateSome();
+        }
+
+        size_t newSize = active.size * 2;
+        swap(active, draining);
+        drainCursor = 0;
+        Allocate(active, newSize);
+    }
+
+    // Pilot bucket of a hash in frozen mode
+    size_t PilotBucket(uint64_t hashValue) const {
+        return PerfectHashBucket(hashValue, pilots.size());
+    }
+
+    // Leaves frozen mode, moving the courses back into a slot array
+    void Thaw() {
+        CourseSlots courses(&arena);
+        courses.swap(frozen);
+        vector<uint32_t>().swap(pilots);
+        isFrozen = false;
+
+        Allocate(active, SlotCountFor(courses.size() + 1));
+        for (Course& course : courses) {
+            uint64_t hashValue = Hash(course.courseNumber);
+            size_t insertSlot = 0;
+            FindSlot(active, course.courseNumber, hashValue, insertSlot);
+            Place(active, insertSlot, hashValue, std::move(course));
+        }
+    }
+
+public:
+    // Constructor — size is the expected number of courses; the slot array
+    // is rounded up to a power-of-two number of groups.
+    BasicHashTable(size_t size = 20) : active(&arena), draining(&arena), frozen(&arena) {
+        Allocate(active, SlotCountFor(size));
+        drainCursor = 0;
+        count = 0;
+        pilotSeed = 0;
+        isFrozen = false;
+        filterRate = 0;
+        filterCapacity = 0;
+        rejectedByFilter = 0;
+        passedFilter = 0;
+        falsePositives = 0;
+        sortedKeys = 0;
+        bulkLoading = false;
+    }
+
+    BasicHashTable(const BasicHashTable&) = delete;
+    BasicHashTable& operator=(const BasicHashTable&) = delete;
+
+    // Insert a new course into the hash table
+    void Insert(const Course& course) {
+        prefixIndex.Clear();
+        if (isFrozen) {
+            Thaw();
+        }
+
+        CourseKey key = course.courseNumber;
+        uint64_t hashValue = Hash(key);
+        size_t insertSlot = 0;
+        size_t drainSlot = 0;
+
+        // Avoid duplicates (the key may still sit in the draining array)
+        if (FindSlot(active, key, hashValue, insertSlot) != active.size ||
+            FindSlot(draining, key, hashValue, drainSlot, drainCursor) != draining.size) {
+            cout << "Warning: Duplicate course '" << course.courseNumber << "' found. Skipping duplicate." << endl;
+            return;
+        }
+
+        if ((count + 1) * kMaxLoadDenominator > active.size * kMaxLoadNumerator) {
+            BeginGrowth();
+            FindSlot(active, key, hashValue, insertSlot);
+        }
+
+        Place(active, insertSlot, hashValue, course);
+        ++count;
+
+        ordered.push_back(key);
+        if (!bulkLoading && ordered.size() - sortedKeys > sortedKeys / 2) {
+            MergeOrdered();
+        }
+
+        if (!filter.Empty()) {
+            if (count > filterCapacity) {
+                RebuildFilter(2 * count);
+            }
+            else {
+                filter.Add(hashValue);
+            }
+        }
+
+        MigrateSome();
+    }
+
+    // Search for a course by course number
+    Course* Search(string_view courseNumber) {
+        return const_cast<Course*>(static_cast<const BasicHashTable&>(*this).Search(courseNumber));
+    }
+
+    // Search never migrates entries, so it is safe on a const table. The
+    // query is trimmed, upper-cased and packed in place, so a lookup of an
+    // ordinary course number makes no heap allocation.
+    const Course* Search(string_view courseNumber) const {
+        CourseKey key;
+        if (!CourseKey::TryFind(courseNumber, key)) {
+            return nullptr;
+        }
+        uint64_t hashValue = Hash(key);
+
+        if (!filter.Empty()) {
+            if (!filter.MayContain(hashValue)) {
+                rejectedByFilter.fetch_add(1, memory_order_relaxed);
+                return nullptr;
+            }
+            passedFilter.fetch_add(1, memory_order_relaxed);
+            const Course* course = Probe(key, hashValue);
+            if (course == nullptr) {
+                falsePositives.fetch_add(1, memory_order_relaxed);
+            }
+            return course;
+        }
+        return Probe(key, hashValue);
+    }
+
+    // Puts a blocked Bloom filter with the given false-positive rate in
+    // front of Search, built from the courses stored now and kept up to
+    // date by Insert. A rate of 0 removes the filter.
+    void EnableNegativeLookupFilter(double falsePositiveRate) {
+        filterRate = falsePositiveRate;
+        if (falsePositiveRate <= 0 || falsePositiveRate >= 1) {
+            filter = BlockedBloomFilter();
+            filterCapacity = 0;
+            return;
+        }
+
+        RebuildFilter(count);
+    }
+
+    // The negative-lookup filter (empty when none is enabled)
+    const BlockedBloomFilter& NegativeLookupFilter() const {
+        return filter;
+    }
+
+    // How the negative-lookup filter has been answering Search
+    LookupStatistics GetLookupStatistics() const {
+        LookupStatistics stats;
+        stats.rejectedByFilter = rejectedByFilter.load(memory_order_relaxed);
+        stats.passedFilter = passedFilter.load(memory_order_relaxed);
+        stats.falsePositives = falsePositives.load(memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    // Sizes the filter for the given number of courses and adds every
+    // stored course to it
+    void RebuildFilter(size_t capacity) {
+        filterCapacity = max<size_t>(capacity, 64);
+        filter.Reset(filterCapacity, filterRate);
+        if (isFrozen) {
+            for (const Course& course : frozen) {
+                filter.Add(Hash(course.courseNumber));
+            }
+        }
+        for (const SlotArray* array : { &active, &draining }) {
+            for (size_t i = FirstLiveSlot(array); i < array->size; ++i) {
+                if (array->control[i] != kEmpty) {
+                    filter.Add(Hash(array->slots[i].courseNumber));
+                }
+            }
+        }
+    }
+
+    // Finds a key in the frozen array or the slot arrays
+    const Course* Probe(CourseKey key, uint64_t hashValue) const {
+        if (isFrozen) {
+            if (frozen.empty()) return nullptr;
+            uint64_t perfectHash = Mix64(hashValue);
+            size_t position = PerfectHashPosition(perfectHash, pilotSeed, pilots[PilotBucket(perfectHash)], frozen.size());
+            const Course& course = frozen[position];
+            return course.courseNumber == key ? &course : nullptr;
+        }
+
+        size_t insertSlot = 0;
+        size_t slot = FindSlot(active, key, hashValue, insertSlot);
+        if (slot != active.size) {
+            return &active.slots[slot];  // Return pointer to found course
+        }
+
+        slot = FindSlot(draining, key, hashValue, insertSlot, drainCursor);
+        if (slot != draining.size) {
+            return &draining.slots[slot];
+        }
+        return nullptr;
+    }
+
+    // Sorts the appended keys and merges them into the sorted run
+    void MergeOrdered() {
+        if (sortedKeys == ordered.size()) return;
+        auto middle = ordered.begin() + static_cast<ptrdiff_t>(sortedKeys);
+        if (!is_sorted(middle, ordered.end())) {
+            sort(middle, ordered.end());
+        }
+        if (sortedKeys != 0 && *middle < ordered[sortedKeys - 1]) {
+            inplace_merge(ordered.begin(), middle, ordered.end());
+        }
+        sortedKeys = ordered.size();
+    }
+
+    // Calls visit(key) for the stored keys in order, starting at the first
+    // not below *lower (or at the first key when lower is null), until visit
+    // returns false. Keys not merged yet are sorted in a copy and merged on
+    // the fly, so a const table is never modified by a reader.
+    template <typename KeyVisitor>
+    void VisitOrderedKeys(const CourseKeyBound* lower, KeyVisitor visit) const {
+        auto sortedEnd = ordered.begin() + static_cast<ptrdiff_t>(sortedKeys);
+        vector<CourseKey> tail(sortedEnd, ordered.end());
+        sort(tail.begin(), tail.end());
+
+        auto a = ordered.begin();
+        auto b = tail.begin();
+        if (lower != nullptr) {
+            a = lower_bound(ordered.begin(), sortedEnd, *lower);
+            b = lower_bound(tail.begin(), tail.end(), *lower);
+        }
+        while (a != sortedEnd || b != tail.end()) {
+            CourseKey key = (b == tail.end() || (a != sortedEnd && *a < *b)) ? *a++ : *b++;
+            if (!visit(key)) return;
+        }
+    }
+
+public:
+
+    // Defers ordering of inserted keys until EndBulkLoad, so loading n
+    // courses in any order costs one sort instead of repeated merges
+    void BeginBulkLoad() {
+        bulkLoading = true;
+    }
+
+    // Merges the keys inserted since BeginBulkLoad into the ordered index
+    void EndBulkLoad() {
+        if (!bulkLoading) return;
+        bulkLoading = false;
+        MergeOrdered();
+    }
+
+    // Calls visit(course) for every stored course in course-number order,
+    // straight from the ordered index: no copy of the courses and no sort
+    // of more than the keys not merged yet
+    template <typename Visitor>
+    void ForEachInOrder(Visitor visit) const {
+        VisitOrderedKeys(nullptr, [&](CourseKey key) {
+            if (const Course* course = Probe(key, Hash(key))) {
+                visit(*course);
+            }
+            return true;
+            });
+    }
+
+    // Calls visit(course) for every course numbered from first to last
+    // inclusive, in order, and returns the number of matches: a binary
+    // search of the ordered index, then one lookup per match
+    template <typename Visitor>
+    size_t ForEachInRange(const CourseKeyBound& first, const CourseKeyBound& last, Visitor visit) const {
+        size_t matches = 0;
+        VisitOrderedKeys(&first, [&](CourseKey key) {
+            if (last < key) return false;
+            if (const Course* course = Probe(key, Hash(key))) {
+                visit(*course);
+                ++matches;
+            }
+            return true;
+            });
+        return matches;
+    }
+
+    // Retrieve all courses in a flat vector (for sorting and listing)
+    vector<Course> GetAllCourses() const {
+        if (isFrozen) {
+            return vector<Course>(frozen.begin(), frozen.end());
+        }
+
+        vector<Course> allCourses;
+        allCourses.reserve(count);
+        for (const SlotArray* array : { &active, &draining }) {
+            for (size_t i = FirstLiveSlot(array); i < array->size; ++i) {
+                if (array->control[i] != kEmpty) {
+                    allCourses.push_back(array->slots[i]);
+                }
+            }
+        }
+        return allCourses;
+    }
+
+    // Clear all stored data and shrink back to the smallest slot array.
+    // The arena owns every course and array, so no course is visited: the
+    // arena releases everything in one step and the control bytes start
+    // over empty.
+    void Clear() {
+        prefixIndex.Clear();
+        ordered.clear();
+        sortedKeys = 0;
+        if (!filter.Empty()) {
+            filter.Reset(filterCapacity, filterRate);
+        }
+        frozen.Abandon();
+        vector<uint32_t>().swap(pilots);
+        isFrozen = false;
+        Abandon(active);
+        Abandon(draining);
+        drainCursor = 0;
+        count = 0;
+        arena.Release();
+        Allocate(active, SlotCountFor(0));
+    }
+
+    // Number of stored courses
+    size_t Size() const {
+        return count;
+    }
+
+    // Number of slots in the active array (one per course when frozen)
+    size_t BucketCount() const {
+        return isFrozen ? frozen.size() : active.size;
+    }
+
+    // Stored courses per slot of the active array
+    double LoadFactor() const {
+        size_t buckets = BucketCount();
+        return buckets == 0 ? 0.0 : static_cast<double>(count) / static_cast<double>(buckets);
+    }
+
+    // Bytes held by the table. The slot arrays (and the frozen array with
+    // its pilots) count as the bucket array, less the slots in use.
+    MemoryUsage GetMemoryUsage() const {
+        MemoryUsage usage;
+        usage.courseRecords = count * sizeof(Course);
+        usage.bucketArray = frozen.size() * sizeof(Course) + pilots.capacity() * sizeof(uint32_t);
+        for (const Course& course : frozen) {
+            usage.prerequisites += course.prerequisites.HeapBytes();
+        }
+        for (const SlotArray* array : { &active, &draining }) {
+            usage.bucketArray += array->size * sizeof(Course) + array->control.capacity();
+            for (size_t i = FirstLiveSlot(array); i < array->size; ++i) {
+                if (array->control[i] != kEmpty) {
+                    usage.prerequisites += array->slots[i].prerequisites.HeapBytes();
+                }
+            }
+        }
+        usage.bucketArray -= usage.courseRecords;
+        usage.indexes = ordered.capacity() * sizeof(CourseKey) + prefixIndex.BytesUsed() + filter.BitCount() / 8;
+        usage.allocatorSlack = arena.SlackBytes();
+        return usage;
+    }
+
+    // True while courses are still being moved out of the previous array
+    bool IsRehashing() const {
+        return draining.size != 0;
+    }
+
+    // Completes any incremental rehash in progress, e.g. before the table
+    // is published as a read-only snapshot
+    void FinishRehash() {
+        if (draining.size != 0) {
+            prefixIndex.Clear();
+        }
+        while (draining.size != 0) {
+            MigrateSome();
+        }
+    }
+
+    // Switches to frozen mode for a catalog that will not change: builds a
+    // minimal perfect hash over every stored course, so each Search is one
+    // probe with no collisions and the slot arrays are released. A later
+    // Insert or Clear thaws the table back into open addressing. Returns
+    // false, leaving the table in open addressing, if no perfect hash could
+    // be found (e.g. a weak hasher gave two keys the same hash).
+    bool Freeze() {
+        if (isFrozen) return true;
+        FinishRehash();
+        prefixIndex.Clear();
+
+        vector<Course> courses;
+        courses.reserve(count);
+        for (SlotArray* array : { &active, &draining }) {
+            for (size_t i = FirstLiveSlot(array); i < array->size; ++i) {
+                if (array->control[i] != kEmpty) {
+                    courses.push_back(std::move(array->slots[i]));
+                }
+            }
+            Release(*array, FirstLiveSlot(array));
+        }
+        drainCursor = 0;
+
+        vector<uint64_t> hashes(courses.size());
+        for (size_t i = 0; i < courses.size(); ++i) {
+            // Re-mixed so weak hashers still spread evenly over the pilots
+            hashes[i] = Mix64(Hash(courses[i].courseNumber));
+        }
+
+        vector<size_t> positions;
+        if (!FindPerfectHash(hashes, kKeysPerPilot, pilotSeed, pilots, positions)) {
+            vector<uint32_t>().swap(pilots);
+            Allocate(active, SlotCountFor(courses.size() + 1));
+            for (Course& course : courses) {
+                uint64_t hashValue = Hash(course.courseNumber);
+                size_t insertSlot = 0;
+                FindSlot(active, course.courseNumber, hashValue, insertSlot);
+                Place(active, insertSlot, hashValue, std::move(course));
+            }
+            return false;
+        }
+
+        frozen.Allocate(courses.size());
+        for (size_t i = 0; i < courses.size(); ++i) {
+            frozen.Construct(positions[i], std::move(courses[i]));
+        }
+        isFrozen = true;
+        return true;
+    }
+
+    // True while the table is in frozen (perfect hash) mode
+    bool IsFrozen() const {
+        return isFrozen;
+    }
+
+    // Builds the prefix index over the stored courses. Call once loading is
+    // done; a later Insert, Clear or Freeze discards it again.
+    void BuildPrefixIndex() {
+        FinishRehash();
+
+        vector<const Course*> courses;
+        courses.reserve(count);
+        ForEachInOrder([&](const Course& course) { courses.push_back(&course); });
+        prefixIndex.Build(std::move(courses));
+    }
+
+    bool HasPrefixIndex() const {
+        return prefixIndex.IsBuilt();
+    }
+
+    // Calls visit(course) for every course whose number starts with prefix,
+    // in course-number order, and returns the number of matches. Without a
+    // prefix index this falls back to scanning and sorting every course.
+    template <typename Visitor>
+    size_t FindByPrefix(string_view prefix, Visitor visit) const {
+        string normalized = ToUpper(string(TrimView(prefix)));
+        if (prefixIndex.IsBuilt()) {
+            return prefixIndex.FindByPrefix(normalized, visit);
+        }
+
+        vector<Course> matches;
+        for (const Course& course : GetAllCourses()) {
+            if (course.courseNumber.ToString().compare(0, normalized.size(), normalized) == 0) {
+                matches.push_back(course);
+            }
+        }
+        sort(matches.begin(), matches.end(), [](const Course& a, const Course& b) {
+            return a.courseNumber < b.courseNumber;
+            });
+        for (const Course& course : matches) {
+            visit(course);
+        }
+        return matches.size();
+    }
+
+    // Histogram of lookup cost: element g counts the stored courses found
+    // after probing g groups (every course takes exactly one when frozen)
+    vector<size_t> ProbeLengthCounts() const {
+        vector<size_t> counts(2, 0);
+        if (isFrozen) {
+            counts[1] = frozen.size();
+            return counts;
+        }
+
+        for (const SlotArray* array : { &active, &draining }) {
+            for (size_t i = FirstLiveSlot(array); i < array->size; ++i) {
+                if (array->control[i] == kEmpty) continue;
+                CourseKey key = array->slots[i].courseNumber;
+                size_t insertSlot = 0;
+                size_t groups = 0;
+                FindSlot(*array, key, Hash(key), insertSlot, FirstLiveSlot(array), &groups);
+                if (groups >= counts.size()) counts.resize(groups + 1, 0);
+                ++counts[groups];
+            }
+        }
+        return counts;
+    }
+};
+
+using HashTable = BasicHashTable<>;
+using HardenedHashTable = BasicHashTable<SipHasher>;  // for untrusted input
+
+// ===============================
+// ROBIN HOOD HASH TABLE CLASS
+// ===============================
+
+// Open-addressing table with Robin Hood linear probing, for catalogs that
+// are edited in place. An insert takes the slot of any resident that is
+// closer to its home slot than the newcomer, which keeps probe lengths
+// short and even. Remove shifts the following run back by one slot
+// (backward-shift deletion), so the table never holds tombstones and
+// lookups do not slow down as courses are replaced.
+template <typename Hasher = SplitMixHasher>
+class RobinHoodHashTable {
+private:
+    static constexpr size_t kMaxLoadNumerator = 7;
+    static constexpr size_t kMaxLoadDenominator = 8;
+
+    // Holds the slots and every course's prerequisite list; the table's
+    // courses are never destroyed one by one. Declared first so it outlives
+    // the slots.
+    CatalogArena arena;
+
+    // distance[i] is 0 for an empty slot, otherwise 1 + how far slots[i]
+    // sits from its home slot. Only slots with a distance hold a course.
+    vector<uint32_t> distance;
+    CourseSlots slots;
+    size_t mask;    // slot count - 1 (the slot count is a power of two)
+    size_t count;   // number of stored courses
+
+    size_t Home(CourseKey key) const {
+        return static_cast<size_t>(Hasher::Hash(key)) & mask;
+    }
+
+    // Slot holding key, or slots.size() when absent. The probe stops as soon
+    // as it meets a resident closer to home than the key would be.
+    size_t FindSlot(CourseKey key) const {
+        size_t pos = Home(key);
+        for (uint32_t d = 1; distance[pos] >= d; ++d) {
+            if (slots[pos].courseNumber == key) {
+                return pos;
+            }
+            pos = (pos + 1) & mask;
+        }
+        return slots.size();
+    }
+
+    // Places a course known not to be stored yet; course uses the arena
+    void Place(Course course) {
+        size_t pos = Home(course.courseNumber);
+        uint32_t d = 1;
+        while (distance[pos] != 0) {
+            // Take from the rich: the resident closer to home moves on
+            if (distance[pos] < d) {
+                swap(course, slots[pos]);
+                swap(d, distance[pos]);
+            }
+            pos = (pos + 1) & mask;
+            ++d;
+        }
+        slots.Construct(pos, std::move(course));
+        distance[pos] = d;
+    }
+
+    // The old slots are freed with their courses moved out
+    void Rehash(size_t slotCount) {
+        vector<uint32_t> oldDistance(slotCount, 0);
+        CourseSlots oldSlots(&arena);
+        oldSlots.Allocate(slotCount);
+        oldDistance.swap(distance);
+        oldSlots.swap(slots);
+        mask = slotCount - 1;
+
+        for (size_t i = 0; i < oldSlots.size(); ++i) {
+            if (oldDistance[i] != 0) {
+                Place(std::move(oldSlots[i]));
+            }
+        }
+    }
+
+    void GrowIfNeeded() {
+        if ((count + 1) * kMaxLoadDenominator > slots.size() * kMaxLoadNumerator) {
+            Rehash(slots.size() * 2);
+        }
+    }
+
+public:
+    // Constructor — size is the expected number of courses
+    RobinHoodHashTable(size_t size = 20) : slots(&arena) {
+        size_t slotCount = 16;
+        while (slotCount * kMaxLoadNumerator < size * kMaxLoadDenominator) {
+            slotCount *= 2;
+        }
+        distance.assign(slotCount, 0);
+        slots.Allocate(slotCount);
+        mask = slotCount - 1;
+        count = 0;
+    }
+
+    // Copies every course into the copy's own arena
+    RobinHoodHashTable(const RobinHoodHashTable& other)
+        : distance(other.distance), slots(&arena), mask(other.mask), count(other.count) {
+        slots.Allocate(other.slots.size());
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (distance[i] != 0) {
+                slots.Construct(i, other.slots[i]);
+            }
+        }
+    }
+
+    RobinHoodHashTable& operator=(const RobinHoodHashTable&) = delete;
+
+    // Insert a new course; a course number already present is kept.
+    // Returns true when the course was stored.
+    bool Insert(const Course& course) {
+        if (FindSlot(course.courseNumber) != slots.size()) {
+            cout << "Warning: Duplicate course '" << course.courseNumber << "' found. Skipping duplicate." << endl;
+            return false;
+        }
+        GrowIfNeeded();
+        Place(Course(course, Course::allocator_type(&arena)));
+        ++count;
+        return true;
+    }
+
+    // Insert a course, or replace the stored course with the same number.
+    // Returns true when the course was new.
+    bool Upsert(const Course& course) {
+        size_t pos = FindSlot(course.courseNumber);
+        if (pos != slots.size()) {
+            slots[pos] = course;
+            return false;
+        }
+        GrowIfNeeded();
+        Place(Course(course, Course::allocator_type(&arena)));
+        ++count;
+        return true;
+    }
+
+    // Remove a course by course number. Returns false when it was not stored.
+    bool Remove(string_view courseNumber) {
+        CourseKey key;
+        if (!CourseKey::TryFind(courseNumber, key)) {
+            return false;
+        }
+        size_t pos = FindSlot(key);
+        if (pos == slots.size()) {
+            return false;
+        }
+
+        // Backward shift: pull each displaced follower one slot closer to home
+        size_t next = (pos + 1) & mask;
+        while (distance[next] > 1) {
+            slots[pos] = std::move(slots[next]);
+            distance[pos] = distance[next] - 1;
+            pos = next;
+            next = (next + 1) & mask;
+        }
+        slots[pos].~Course();
+        distance[pos] = 0;
+        --count;
+        return true;
+    }
+
+    // Search for a course by course number
+    Course* Search(string_view courseNumber) {
+        return const_cast<Course*>(static_cast<const RobinHoodHashTable&>(*this).Search(courseNumber));
+    }
+
+    const Course* Search(string_view courseNumber) const {
+        CourseKey key;
+        if (!CourseKey::TryFind(courseNumber, key)) {
+            return nullptr;
+        }
+        return Find(key);
+    }
+
+    // Search by an already normalized key
+    const Course* Find(CourseKey key) const {
+        size_t pos = FindSlot(key);
+        return pos == slots.size() ? nullptr : &slots[pos];
+    }
+
+    // Retrieve all courses in a flat vector (for sorting and listing)
+    vector<Course> GetAllCourses() const {
+        vector<Course> allCourses;
+        allCourses.reserve(count);
+        ForEach([&](const Course& course) { allCourses.push_back(course); });
+        return allCourses;
+    }
+
+    // Calls visit(course) for every stored course, in slot order
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (distance[i] != 0) {
+                visit(slots[i]);
+            }
+        }
+    }
+
+    // Bytes held by the table: the slot and distance arrays, less the slots
+    // in use, and the prerequisite lists too long to stay inline
+    MemoryUsage GetMemoryUsage() const {
+        MemoryUsage usage;
+        usage.courseRecords = count * sizeof(Course);
+        usage.bucketArray = slots.size() * sizeof(Course) + distance.capacity() * sizeof(uint32_t)
+            - usage.courseRecords;
+        ForEach([&](const Course& course) { usage.prerequisites += course.prerequisites.HeapBytes(); });
+        usage.allocatorSlack = arena.SlackBytes();
+        return usage;
+    }
+
+    // Clear all stored data (the current bucket count is kept). No course
+    // is visited: the arena releases them all and the distances start over.
+    void Clear() {
+        size_t slotCount = slots.size();
+        slots.Abandon();
+        arena.Release();
+        slots.Allocate(slotCount);
+        distance.assign(slotCount, 0);
+        count = 0;
+    }
+
+    size_t Size() const {
+        return count;
+    }
+
+    size_t BucketCount() const {
+        return slots.size();
+    }
+
+    double LoadFactor() const {
+        return static_cast<double>(count) / static_cast<double>(slots.size());
+    }
+};
+
+// ===============================
+// CONCURRENT HASH TABLE CLASS
+// ===============================
+
+// Epoch-based reclamation shared by every ConcurrentHashTable. A reader
+// announces the global epoch in its own slot for the duration of a lookup;
+// a writer that unlinks memory tags it with a newer epoch and frees it only
+// once no reader still announces an older one. Announcing is one load and
+// one store, so readers never wait on writers. Slots come in blocks, and a
+// thread that finds every slot taken appends another block, so any number
+// of threads can read.
+class EpochDomain {
+private:
+    struct alignas(64) Slot {
+        atomic<uint64_t> epoch{ 0 };     // 0 while the thread is not reading
+        atomic<bool> claimed{ false };
+        size_t depth = 0;                // nesting, touched only by the owner
+    };
+
+    static constexpr size_t kSlotsPerBlock = 64;
+
+    struct Block {
+        Slot slots[kSlotsPerBlock];
+        atomic<Block*> next{ nullptr };  // set once, never removed
+    };
+
+    // Releases the thread's slot when the thread exits
+    struct SlotOwner {
+        Slot* slot = nullptr;
+        ~SlotOwner() {
+            if (slot != nullptr) slot->claimed.store(false);
+        }
+    };
+
+public:
+    EpochDomain() = default;
+    ~EpochDomain() {
+        for (Block* block = firstBlock.next.load(); block != nullptr;) {
+            Block* next = block->next.load();
+            delete block;
+            block = next;
+        }
+    }
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    static EpochDomain& Global() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // Marks the calling thread as reading for the lifetime of the guard
+    class ReadGuard {
+    public:
+        ReadGuard() : slot(EpochDomain::Global().ThreadSlot()) {
+            if (slot.depth++ == 0) {
+                slot.epoch.store(EpochDomain::Global().epoch.load());
+            }
+        }
+        ~ReadGuard() {
+            if (--slot.depth == 0) {
+                slot.epoch.store(0);
+            }
+        }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        Slot& slot;
+    };
+
+    // Starts a new epoch; memory unlinked before this call may be freed once
+    // CanReclaim returns true for the returned value
+    uint64_t Advance() {
+        return epoch.fetch_add(1) + 1;
+    }
+
+    // True when no reader is still inside an epoch older than retireEpoch
+    bool CanReclaim(uint64_t retireEpoch) const {
+        for (const Block* block = &firstBlock; block != nullptr; block = block->next.load()) {
+            for (const Slot& s : block->slots) {
+                uint64_t announced = s.epoch.load();
+                if (announced != 0 && announced < retireEpoch) return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    atomic<uint64_t> epoch{ 1 };
+    Block firstBlock;
+
+    Slot& ThreadSlot() {
+        thread_local SlotOwner owner;
+        if (owner.slot == nullptr) {
+            owner.slot = &ClaimSlot();
+        }
+        return *owner.slot;
+    }
+
+    // A free slot, from a new block appended when every slot is taken
+    Slot& ClaimSlot() {
+        for (Block* block = &firstBlock; ; ) {
+            for (Slot& s : block->slots) {
+                bool expected = false;
+                if (s.claimed.compare_exchange_strong(expected, true)) return s;
+            }
+
+            Block* next = block->next.load();
+            if (next == nullptr) {
+                // The new block is published with its first slot already ours
+                unique_ptr<Block> added = make_unique<Block>();
+                added->slots[0].claimed.store(true);
+                if (block->next.compare_exchange_strong(next, added.get())) {
+                    return added.release()->slots[0];
+                }
+                // Another thread appended a block first; try that one
+            }
+            block = next;
+        }
+    }
+};
+
+// Thread-safe course table for serving lookups from many threads. Search is
+// wait-free: it announces an epoch, loads the current slot array and probes
+// at most a bounded number of slots, never taking a lock or retrying (a
+// course number too long to pack is found in the long-identifier table,
+// which readers also use without a lock).
+// Writers (Insert, Clear) serialize on a mutex among themselves only. A
+// published course is never modified; growing copies slot pointers into a
+// new array, and the old array is freed through the epoch domain once the
+// last reader that could see it has finished. Courses are built in an arena
+// that Clear retires along with the array, so the courses of a cleared
+// table go back in one step rather than one delete each.
+template <typename Hasher = SplitMixHasher>
+class ConcurrentHashTable {
+private:
+    struct SlotArray {
+        size_t mask;                              // slot count - 1
+        unique_ptr<atomic<const Course*>[]> slots;
+
+        explicit SlotArray(size_t slotCount) : mask(slotCount - 1), slots(new atomic<const Course*>[slotCount]) {
+            for (size_t i = 0; i < slotCount; ++i) {
+                slots[i].store(nullptr, memory_order_relaxed);
+            }
+        }
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        SlotArray* array;
+        CatalogArena* courses;   // the courses that died with the array (Clear), or null
+    };
+
+    atomic<SlotArray*> current;
+    atomic<size_t> count;
+    mutex writeLock;
+    vector<Retired> retired;              // guarded by writeLock
+    unique_ptr<CatalogArena> courseArena; // the courses in current; guarded by writeLock
+
+    // Probe for key in one array; the array is at most half full, so the
+    // loop always reaches an empty slot
+    static const Course* Find(const SlotArray& array, CourseKey key) {
+        for (size_t pos = static_cast<size_t>(Hasher::Hash(key)) & array.mask; ; pos = (pos + 1) & array.mask) {
+            const Course* course = array.slots[pos].load(memory_order_acquire);
+            if (course == nullptr || course->courseNumber == key) {
+                return course;
+            }
+        }
+    }
+
+    static void Place(SlotArray& array, const Course* course) {
+        size_t pos = static_cast<size_t>(Hasher::Hash(course->courseNumber)) & array.mask;
+        while (array.slots[pos].load(memory_order_relaxed) != nullptr) {
+            pos = (pos + 1) & array.mask;
+        }
+        array.slots[pos].store(course, memory_order_release);
+    }
+
+    // The courses are arena-owned and never destroyed one by one
+    static void Destroy(SlotArray* array, CatalogArena* courses) {
+        delete array;
+        delete courses;
+    }
+
+    // Unlinks an array (and the arena of its courses, when they die with
+    // it) and frees whatever no reader can still reach
+    void Retire(SlotArray* array, CatalogArena* courses) {
+        retired.push_back({ EpochDomain::Global().Advance(), array, courses });
+
+        size_t kept = 0;
+        for (const Retired& r : retired) {
+            if (EpochDomain::Global().CanReclaim(r.epoch)) {
+                Destroy(r.array, r.courses);
+            }
+            else {
+                retired[kept++] = r;
+            }
+        }
+        retired.resize(kept);
+    }
+
+public:
+    // Constructor — size is the expected number of courses
+    ConcurrentHashTable(size_t size = 20) : count(0), courseArena(make_unique<CatalogArena>()) {
+        size_t slotCount = 16;
+        while (slotCount < size * 2) {
+            slotCount *= 2;
+        }
+        current.store(new SlotArray(slotCount));
+    }
+
+    // No reader may still be using the table when it is destroyed
+    ~ConcurrentHashTable() {
+        for (const Retired& r : retired) {
+            Destroy(r.array, r.courses);
+        }
+        delete current.load();
+    }
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    // Insert a new course; a course number already present is kept
+    void Insert(const Course& course) {
+        lock_guard<mutex> guard(writeLock);
+        SlotArray* array = current.load();
+
+        if (Find(*array, course.courseNumber) != nullptr) {
+            cout << "Warning: Duplicate course '" << course.courseNumber << "' found. Skipping duplicate." << endl;
+            return;
+        }
+
+        // Stay at most half full so probes stay short and bounded
+        size_t slotCount = array->mask + 1;
+        if ((count.load() + 1) * 2 > slotCount) {
+            SlotArray* bigger = new SlotArray(slotCount * 2);
+            for (size_t i = 0; i < slotCount; ++i) {
+                const Course* existing = array->slots[i].load(memory_order_relaxed);
+                if (existing != nullptr) Place(*bigger, existing);
+            }
+            current.store(bigger);
+            Retire(array, nullptr);
+            array = bigger;
+        }
+
+        void* storage = courseArena->allocate(sizeof(Course), alignof(Course));
+        Place(*array, new (storage) Course(course, Course::allocator_type(courseArena.get())));
+        count.fetch_add(1);
+    }
+
+    // Wait-free lookup. visit(const Course&) runs while the course is
+    // guaranteed to stay alive; returns false when the course is not stored.
+    template <typename Visitor>
+    bool Search(string_view courseNumber, Visitor&& visit) const {
+        CourseKey key;
+        if (!CourseKey::TryFind(courseNumber, key)) {
+            return false;
+        }
+
+        EpochDomain::ReadGuard guard;
+        const Course* course = Find(*current.load(), key);
+        if (course == nullptr) {
+            return false;
+        }
+        visit(*course);
+        return true;
+    }
+
+    // Copying lookup for callers that need the course after returning
+    bool Search(string_view courseNumber, Course& result) const {
+        return Search(courseNumber, [&](const Course& c) { result = c; });
+    }
+
+    // Retrieve all courses in a flat vector (for sorting and listing)
+    vector<Course> GetAllCourses() const {
+        EpochDomain::ReadGuard guard;
+        const SlotArray* array = current.load();
+        vector<Course> allCourses;
+        for (size_t i = 0; i <= array->mask; ++i) {
+            const Course* course = array->slots[i].load(memory_order_acquire);
+            if (course != nullptr) allCourses.push_back(*course);
+        }
+        return allCourses;
+    }
+
+    // Clear all stored data; readers still inside a lookup keep the old data
+    void Clear() {
+        lock_guard<mutex> guard(writeLock);
+        SlotArray* array = current.load();
+        current.store(new SlotArray(array->mask + 1));
+        count.store(0);
+        Retire(array, courseArena.release());
+        courseArena = make_unique<CatalogArena>();
+    }
+
+    size_t Size() const {
+        return count.load();
+    }
+};
+
+// ===============================
+// B+TREE CLASS
+// ===============================
+
+// In-memory B+tree of courses keyed on course number, for ordered and range
+// queries. Nodes are wide, so the tree stays a few levels deep, and each
+// node keeps its keys in one contiguous array, separate from the child
+// pointers or courses, so a node search reads only a few cache lines. All
+// courses sit in the leaves, which are linked in key order, so a range scan
+// is one descent followed by a sequential walk along the leaves.
+class BPlusTree {
+private:
+    static constexpr size_t kLeafCapacity = 16;   // courses per leaf
+    static constexpr size_t kInnerCapacity = 32;  // keys per inner node
+
+    struct Node {
+        bool isLeaf;
+        size_t count;  // keys in use
+    };
+
+    struct Leaf : Node {
+        CourseKey keys[kLeafCapacity];
+        Course courses[kLeafCapacity];
+        Leaf* next;
+
+        // Every course slot keeps its prerequisites in alloc's arena
+        explicit Leaf(const Course::allocator_type& alloc) : Leaf(alloc, make_index_sequence<kLeafCapacity>()) {}
+
+    private:
+        template <size_t... Slot>
+        Leaf(const Course::allocator_type& alloc, index_sequence<Slot...>)
+            : courses{ (static_cast<void>(Slot), Course(alloc))... } {}
+    };
+
+    // children[i] holds the keys below keys[i]; children[count] the rest
+    struct Inner : Node {
+        CourseKey keys[kInnerCapacity];
+        Node* children[kInnerCapacity + 1];
+    };
+
+    // Holds every node and the prerequisite lists of the courses in them.
+    // Nodes are never freed or destroyed individually, so the tree needs no
+    // recursive teardown and Clear is one Release.
+    CatalogArena arena;
+    size_t leafCount;
+    size_t innerCount;
+    Node* root;
+    Leaf* firstLeaf;
+    size_t count;
+    size_t height;
+
+    Leaf* NewLeaf() {
+        Leaf* leaf = new (arena.allocate(sizeof(Leaf), alignof(Leaf))) Leaf(Course::allocator_type(&arena));
+        ++leafCount;
+        leaf->isLeaf = true;
+        leaf->count = 0;
+        leaf->next = nullptr;
+        return leaf;
+    }
+
+    Inner* NewInner() {
+        Inner* inner = new (arena.allocate(sizeof(Inner), alignof(Inner))) Inner;
+        ++innerCount;
+        inner->isLeaf = false;
+        inner->count = 0;
+        return inner;
+    }
+
+    // Leaf that holds, or would hold, the keys around bound: a lower or
+    // upper bound search continues from there (moving on to the next leaf
+    // if it runs off the end). path, when given, receives the inner nodes
+    // passed and the child index taken in each.
+    template <typename Bound>
+    const Leaf* FindLeaf(const Bound& bound, vector<pair<Inner*, size_t>>* path = nullptr) const {
+        Node* node = root;
+        while (!node->isLeaf) {
+            Inner* inner = static_cast<Inner*>(node);
+            size_t child = upper_bound(inner->keys, inner->keys + inner->count, bound) - inner->keys;
+            if (path != nullptr) path->emplace_back(inner, child);
+            node = inner->children[child];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    // Adds separator, with right as the child after it, to the inner node
+    // at path[level - 1], splitting full nodes upward as far as needed
+    void InsertSeparator(vector<pair<Inner*, size_t>>& path, size_t level, CourseKey separator, Node* right) {
+        while (true) {
+            if (level == 0 && path.empty()) {
+                // The root split: grow the tree by one level
+                Inner* newRoot = NewInner();
+                newRoot->count = 1;
+                newRoot->keys[0] = separator;
+                newRoot->children[0] = root;
+                newRoot->children[1] = right;
+                root = newRoot;
+                ++height;
+                return;
+            }
+
+            Inner* inner = path[level - 1].first;
+            size_t at = path[level - 1].second;
+
+            if (inner->count < kInnerCapacity) {
+                copy_backward(inner->keys + at, inner->keys + inner->count, inner->keys + inner->count + 1);
+                copy_backward(inner->children + at + 1, inner->children + inner->count + 1, inner->children + inner->count + 2);
+                inner->keys[at] = separator;
+                inner->children[at + 1] = right;
+                ++inner->count;
+                return;
+            }
+
+            // Split a full inner node around its middle key, which moves up
+            CourseKey keys[kInnerCapacity + 1];
+            Node* children[kInnerCapacity + 2];
+            copy(inner->keys, inner->keys + at, keys);
+            keys[at] = separator;
+            copy(inner->keys + at, inner->keys + inner->count, keys + at + 1);
+            copy(inner->children, inner->children + at + 1, children);
+            children[at + 1] = right;
+            copy(inner->children + at + 1, inner->children + inner->count + 1, children + at + 2);
+
+            size_t middle = (kInnerCapacity + 1) / 2;
+            Inner* sibling = NewInner();
+            inner->count = middle;
+            copy(keys, keys + middle, inner->keys);
+            copy(children, children + middle + 1, inner->children);
+            sibling->count = kInnerCapacity - middle;
+            copy(keys + middle + 1, keys + kInnerCapacity + 1, sibling->keys);
+            copy(children + middle + 1, children + kInnerCapacity + 2, sibling->children);
+
+            separator = keys[middle];
+            right = sibling;
+            path.pop_back();
+            level = path.size();
+        }
+    }
+
+public:
+    // Forward iterator over courses in key order
+    class ConstIterator {
+    public:
+        ConstIterator() : leaf(nullptr), index(0) {}
+
+        const Course& operator*() const { return leaf->courses[index]; }
+        const Course* operator->() const { return &leaf->courses[index]; }
+
+        ConstIterator& operator++() {
+            if (++index == leaf->count) {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        bool operator==(const ConstIterator& other) const { return leaf == other.leaf && index == other.index; }
+        bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+
+    private:
+        friend class BPlusTree;
+
+        // Steps past the end of a leaf onto the start of the next one
+        ConstIterator(const Leaf* at, size_t position) : leaf(at), index(position) {
+            if (leaf != nullptr && index == leaf->count) {
+                leaf = leaf->next;
+                index = 0;
+            }
+        }
+
+        const Leaf* leaf;
+        size_t index;
+    };
+
+    BPlusTree() {
+        Clear();
+    }
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    // Adds a course; returns false (and stores nothing) if its course number
+    // is already present
+    bool Insert(const Course& course) {
+        CourseKey key = course.courseNumber;
+        vector<pair<Inner*, size_t>> path;
+        path.reserve(height);
+        Leaf* leaf = const_cast<Leaf*>(FindLeaf(key, &path));
+
+        size_t at = lower_bound(leaf->keys, leaf->keys + leaf->count, key) - leaf->keys;
+        if (at < leaf->count && leaf->keys[at] == key) {
+            return false;
+        }
+        ++count;
+
+        if (leaf->count == kLeafCapacity) {
+            // Split a full leaf in half; the right half's first key goes up.
+            // Appending past the last leaf (a sorted load) leaves it full
+            // and starts a new one instead, so leaves do not end half empty.
+            bool append = at == kLeafCapacity && leaf->next == nullptr;
+            Leaf* sibling = NewLeaf();
+            size_t half = append ? kLeafCapacity : kLeafCapacity / 2;
+            for (size_t i = half; i < kLeafCapacity; ++i) {
+                sibling->keys[i - half] = leaf->keys[i];
+                sibling->courses[i - half] = std::move(leaf->courses[i]);
+            }
+            sibling->count = kLeafCapacity - half;
+            leaf->count = half;
+            sibling->next = leaf->next;
+            leaf->next = sibling;
+
+            InsertSeparator(path, path.size(), append ? key : sibling->keys[0], sibling);
+            if (append || at > half) {
+                leaf = sibling;
+                at -= half;
+            }
+        }
+
+        for (size_t i = leaf->count; i > at; --i) {
+            leaf->keys[i] = leaf->keys[i - 1];
+            leaf->courses[i] = std::move(leaf->courses[i - 1]);
+        }
+        leaf->keys[at] = key;
+        leaf->courses[at] = course;
+        ++leaf->count;
+        return true;
+    }
+
+    // Search for a course by course number (any spacing or letter case)
+    const Course* Search(string_view courseNumber) const {
+        CourseKey key;
+        if (!CourseKey::TryFind(courseNumber, key)) {
+            return nullptr;
+        }
+        const Leaf* leaf = FindLeaf(key);
+        size_t at = lower_bound(leaf->keys, leaf->keys + leaf->count, key) - leaf->keys;
+        return at < leaf->count && leaf->keys[at] == key ? &leaf->courses[at] : nullptr;
+    }
+
+    ConstIterator begin() const {
+        return ConstIterator(firstLeaf, 0);
+    }
+
+    ConstIterator end() const {
+        return ConstIterator();
+    }
+
+    // First course whose number is not below bound
+    ConstIterator LowerBound(const CourseKeyBound& bound) const {
+        const Leaf* leaf = FindLeaf(bound);
+        size_t at = lower_bound(leaf->keys, leaf->keys + leaf->count, bound) - leaf->keys;
+        return ConstIterator(leaf, at);
+    }
+
+    // First course whose number is above bound
+    ConstIterator UpperBound(const CourseKeyBound& bound) const {
+        const Leaf* leaf = FindLeaf(bound);
+        size_t at = upper_bound(leaf->keys, leaf->keys + leaf->count, bound) - leaf->keys;
+        return ConstIterator(leaf, at);
+    }
+
+    // Courses numbered from first to last inclusive, as an iterator pair:
+    // two descents, then a walk along the linked leaves
+    pair<ConstIterator, ConstIterator> Range(const CourseKeyBound& first, const CourseKeyBound& last) const {
+        if (last < first) {
+            return { end(), end() };
+        }
+        return { LowerBound(first), UpperBound(last) };
+    }
+
+    size_t Size() const {
+        return count;
+    }
+
+    // Levels from the root to the leaves (1 for a lone leaf)
+    size_t Height() const {
+        return height;
+    }
+
+    size_t LeafCount() const {
+        return leafCount;
+    }
+
+    size_t InnerCount() const {
+        return innerCount;
+    }
+
+    // Bytes held by the tree. Unused course slots in the leaves count as
+    // the bucket array; keys, links and headers as node overhead.
+    MemoryUsage GetMemoryUsage() const {
+        MemoryUsage usage;
+        usage.courseRecords = count * sizeof(Course);
+        usage.bucketArray = leafCount * kLeafCapacity * sizeof(Course) - usage.courseRecords;
+        usage.nodeOverhead = leafCount * (sizeof(Leaf) - kLeafCapacity * sizeof(Course))
+            + innerCount * sizeof(Inner);
+        for (const Course& course : *this) {
+            usage.prerequisites += course.prerequisites.HeapBytes();
+        }
+        usage.allocatorSlack = arena.SlackBytes();
+        return usage;
+    }
+
+    // Removes every course and frees every node, in one arena Release
+    void Clear() {
+        arena.Release();
+        leafCount = 0;
+        innerCount = 0;
+        firstLeaf = NewLeaf();
+        root = firstLeaf;
+        count = 0;
+        height = 1;
+    }
+};
+
+// ===============================
+// EMBEDDED CATALOG
+// ===============================
+
+// One course of a catalog compiled into the program. The header produced by
+// --embed-catalog defines kEmbeddedCourses (sorted by course number, with
+// normalized course numbers) and kEmbeddedPrerequisites, plus the minimal
+// perfect hash over them: kEmbeddedHashSeed, kEmbeddedPilots and
+// kEmbeddedCourseAt (the course index stored at each position).
+struct EmbeddedCourse {
+    const char* courseNumber;
+    const char* courseTitle;
+    size_t firstPrerequisite;   // index into kEmbeddedPrerequisites
+    size_t prerequisiteCount;
+};
+
+// ASCII upper-casing usable in constant expressions
+constexpr char AsciiUpper(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// FNV-1a over the upper-cased characters, so a trimmed query in any letter
+// case hashes the same as the normalized course number. The final mix
+// spreads FNV's weak high bits, which pick the perfect-hash bucket.
+constexpr uint64_t EmbeddedHash(string_view key) {
+    uint64_t hashValue = 0xCBF29CE484222325ULL;
+    for (char c : key) {
+        hashValue ^= static_cast<unsigned char>(AsciiUpper(c));
+        hashValue *= 0x100000001B3ULL;
+    }
+    return Mix64(hashValue);
+}
+
+// Keys per pilot the generator aims for in the embedded perfect hash
+constexpr size_t kEmbeddedKeysPerPilot = 4;
+
+#ifdef ADVISING_EMBEDDED_CATALOG
+#include ADVISING_EMBEDDED_CATALOG
+
+// Read-only view of the compiled-in catalog. The generator has already
+// built the perfect hash, so the compiler only lays out constant tables and
+// there is nothing to open, parse or index at startup.
+class EmbeddedCatalog {
+private:
+    static constexpr size_t kCourseCount = sizeof(kEmbeddedCourses) / sizeof(kEmbeddedCourses[0]);
+    static constexpr size_t kPilotCount = sizeof(kEmbeddedPilots) / sizeof(kEmbeddedPilots[0]);
+    static_assert(sizeof(kEmbeddedCourseAt) / sizeof(kEmbeddedCourseAt[0]) == kCourseCount,
+                  "embedded catalog header is out of date; regenerate it with --embed-catalog");
+
+public:
+    // Search for a course by course number (any letter case)
+    const EmbeddedCourse* Search(string_view courseNumber) const {
+        string_view key = TrimView(courseNumber);
+        uint64_t hashValue = EmbeddedHash(key);
+        size_t position = PerfectHashPosition(hashValue, kEmbeddedHashSeed,
+                                              kEmbeddedPilots[PerfectHashBucket(hashValue, kPilotCount)], kCourseCount);
+        const EmbeddedCourse& course = kEmbeddedCourses[kEmbeddedCourseAt[position]];
+
+        string_view stored = course.courseNumber;
+        if (stored.size() != key.size()) return nullptr;
+        for (size_t i = 0; i < key.size(); ++i) {
+            if (stored[i] != AsciiUpper(key[i])) return nullptr;
+        }
+        return &course;
+    }
+
+    // Courses in course-number order
+    const EmbeddedCourse* begin() const { return kEmbeddedCourses; }
+    const EmbeddedCourse* end() const { return kEmbeddedCourses + kCourseCount; }
+
+    size_t Size() const {
+        return kCourseCount;
+    }
+
+    // The compiled-in catalog never changes, so it is its own snapshot
+    const EmbeddedCatalog* Snapshot() const {
+        return this;
+    }
+};
+#endif
+
+// ===============================
+// CATALOG STORES
+// ===============================
+
+// Storage layouts a catalog can be loaded into, picked at startup
+enum class StorageBackend {
+    Vector,  // sorted vector: binary-search lookups, cheapest to list
+    Tree,    // balanced BST: logarithmic lookups and inserts
+    BPlusTree,  // B+tree: wide nodes and linked leaves for range scans
+    Partitioned,  // one hash table per department
+    RobinHood,  // Robin Hood hash table: courses can be updated and removed
+    Hash     // hash table: constant-time lookups (the default)
+};
+
+// How LoadCourses prepares a store for lookups
+struct LoadOptions {
+    StorageBackend backend = StorageBackend::Hash;
+    bool freezeCatalog = false;         // hash store: switch to frozen (perfect hash) mode
+    double bloomFalsePositiveRate = 0;  // hash store: > 0 puts a Bloom filter before Search
+    bool seededHash = false;            // hash store: hash keys with SipHash under a per-process key
+    bool filterDepartment = false;      // load only the courses of department
+    string department;
+    unsigned loadThreads = 0;           // threads that parse the file; 0: one per core
+};
+
+// Common interface of the catalog storage backends, so loading, printing
+// and the menu work the same whichever layout holds the courses
+class CatalogStore {
+public:
+    using Visitor = function<void(const Course&)>;
+
+    virtual ~CatalogStore() = default;
+
+    // Short name of the layout, e.g. "hash table"
+    virtual const char* Name() const = 0;
+
+    // Adds a course; a duplicate course number is reported and skipped
+    virtual void Insert(const Course& course) = 0;
+
+    // Finds a course by course number (any spacing or letter case)
+    virtual const Course* Search(string_view courseNumber) const = 0;
+
+    // Visits every course in course-number order
+    virtual void ForEachInOrder(const Visitor& visit) const = 0;
+
+    // Visits, in order, every course whose number starts with prefix (any
+    // spacing or letter case) and returns the number of matches
+    virtual size_t FindByPrefix(string_view prefix, const Visitor& visit) const = 0;
+
+    // Visits, in order, every course numbered from first to last inclusive
+    // and returns the number of matches
+    virtual size_t FindInRange(string_view first, string_view last, const Visitor& visit) const = 0;
+
+    virtual size_t Size() const = 0;
+    virtual void Clear() = 0;
+
+    // Bracket a load of many courses, so a store can defer ordering work
+    virtual void BeginBulkLoad() {}
+    virtual void EndBulkLoad() {}
+
+    // Applies the options that concern this layout once loading is done
+    virtual void FinishLoading(const LoadOptions& options) { (void)options; }
+
+    // Prints the size and layout details of the store
+    virtual void PrintStatistics() const {
+        cout << "\nCourses: " << Size() << endl;
+        cout << "Storage: " << Name() << "\n" << endl;
+    }
+
+    // Bytes the store holds, by category (the shared key and title pools
+    // are not included)
+    virtual MemoryUsage GetMemoryUsage() const = 0;
+
+    // Pool the titles of this store's courses are interned into. Copies of
+    // a store share it, so it lives as long as any of them.
+    TitlePool* Titles() const { return titles.get(); }
+
+    // Starts an empty title pool, for a store that holds no courses
+    void ResetTitles() { titles = make_shared<TitlePool>(); }
+
+    // Bytes held by the store's title pools
+    virtual size_t TitleBytes() const { return titles->BytesUsed(); }
+
+private:
+    shared_ptr<TitlePool> titles = make_shared<TitlePool>();
+};
+
+// Visits courses in order from first (the lower bound of the prefix) until
+// one no longer starts with prefix (normalized)
+template <typename Iterator, typename GetCourse>
+size_t VisitPrefixRun(Iterator first, Iterator last, const string& prefix, GetCourse getCourse,
+                      const CatalogStore::Visitor& visit) {
+    size_t matches = 0;
+    for (; first != last; ++first, ++matches) {
+        const Course& course = getCourse(*first);
+        if (course.courseNumber.ToString().compare(0, prefix.size(), prefix) != 0) break;
+        visit(course);
+    }
+    return matches;
+}
+
+// Visits courses in order from first (the lower bound of the range) until
+// one is numbered above upper
+template <typename Iterator, typename GetCourse>
+size_t VisitRangeRun(Iterator first, Iterator last, const CourseKeyBound& upper, GetCourse getCourse,
+                     const CatalogStore::Visitor& visit) {
+    size_t matches = 0;
+    for (; first != last; ++first, ++matches) {
+        const Course& course = getCourse(*first);
+        if (upper < course.courseNumber) break;
+        visit(course);
+    }
+    return matches;
+}
+
+// Courses kept sorted in one vector, as in the vector milestone. Lookups
+// are binary searches; a bulk load appends and sorts once at the end.
+class VectorCatalogStore : public CatalogStore {
+private:
+    CatalogArena arena;  // declared first so it outlives the courses
+    pmr::vector<Course> courses{ &arena };
+    bool bulkLoading = false;
+
+    static bool ByNumber(const Course& a, const Course& b) {
+        return a.courseNumber < b.courseNumber;
+    }
+
+    template <typename Key>
+    pmr::vector<Course>::const_iterator LowerBound(const Key& key) const {
+        return lower_bound(courses.begin(), courses.end(), key, [](const Course& c, const Key& k) {
+            return c.courseNumber < k;
+            });
+    }
+
+    static const Course& Self(const Course& c) {
+        return c;
+    }
+
+public:
+    const char* Name() const override {
+        return "sorted vector";
+    }
+
+    void Insert(const Course& course) override {
+        if (bulkLoading) {
+            courses.push_back(course);
+            return;
+        }
+
+        auto position = LowerBound(course.courseNumber);
+        if (position != courses.end() && position->courseNumber == course.courseNumber) {
+            cout << "Warning: Duplicate course '" << course.courseNumber << "' found. Skipping duplicate." << endl;
+            return;
+        }
+        courses.insert(position, course);
+    }
+
+    const Course* Search(string_view courseNumber) const override {
+        CourseKey key;
+        if (!CourseKey::TryFind(courseNumber, key)) {
+            return nullptr;
+        }
+        auto position = LowerBound(key);
+        return position != courses.end() && position->courseNumber == key ? &*position : nullptr;
+    }
+
+    void ForEachInOrder(const Visitor& visit) const override {
+        for (const Course& course : courses) {
+            visit(course);
+        }
+    }
+
+    size_t FindByPrefix(string_view prefix, const Visitor& visit) const override {
+        CourseKeyBound start(prefix);
+        return VisitPrefixRun(LowerBound(start), courses.end(), start.Text(), Self, visit);
+    }
+
+    size_t FindInRange(string_view first, string_view last, const Visitor& visit) const override {
+        CourseKeyBound lower(first), upper(last);
+        return VisitRangeRun(LowerBound(lower), courses.end(), upper, Self, visit);
+    }
+
+    size_t Size() const override {
+        return courses.size();
+    }
+
+    void Clear() override {
+        pmr::vector<Course>(&arena).swap(courses);
+        arena.Release();
+    }
+
+    void BeginBulkLoad() override {
+        bulkLoading = true;
+    }
+
+    // Sorts the loaded courses; of several with one course number the
+    // first loaded is kept, as with one-at-a-time inserts
+    void EndBulkLoad() override {
+        if (!bulkLoading) return;
+        bulkLoading = false;
+        stable_sort(courses.begin(), courses.end(), ByNumber);
+
+        size_t kept = 0;
+        for (size_t i = 0; i < courses.size(); ++i) {
+            if (kept > 0 && courses[kept - 1].courseNumber == courses[i].courseNumber) {
+                cout << "Warning: Duplicate course '" << courses[i].courseNumber << "' found. Skipping duplicate." << endl;
+                continue;
+            }
+            if (kept != i) courses[kept] = std::move(courses[i]);
+            ++kept;
+        }
+        courses.resize(kept);
+    }
+
+    void PrintStatistics() const override {
+        cout << "\nCourses: " << courses.size() << endl;
+        cout << "Storage: " << Name() << ", capacity " << courses.capacity() << "\n" << endl;
+    }
+
+    // Unused capacity of the course array counts as the bucket array
+    MemoryUsage GetMemoryUsage() const override {
+        MemoryUsage usage;
+        usage.courseRecords = courses.size() * sizeof(Course);
+        usage.bucketArray = (courses.capacity() - courses.size()) * sizeof(Course);
+        for (const Course& course : courses) {
+            usage.prerequisites += course.prerequisites.HeapBytes();
+        }
+        usage.allocatorSlack = arena.SlackBytes();
+        return usage;
+    }
+};
+
+// Courses in a balanced binary search tree (std::map is a red-black tree),
+// the successor to the BST milestone without its worst-case chains
+class TreeCatalogStore : public CatalogStore {
+private:
+    CatalogArena arena;  // holds the tree nodes; declared first so it outlives them
+    pmr::map<CourseKey, Course, less<>> courses{ &arena };  // transparent, for CourseKeyBound lookups
+
+    static const Course& Value(const pair<const CourseKey, Course>& entry) {
+        return entry.second;
+    }
+
+public:
+    const char* Name() const override {
+        return "balanced BST";
+    }
+
+    void Insert(const Course& course) override {
+        if (!courses.emplace(course.courseNumber, course).second) {
+            cout << "Warning: Duplicate course '" << course.courseNumber << "' found. Skipping duplicate." << endl;
+        }
+    }
+
+    const Course* Search(string_view courseNumber) const override {
+        CourseKey key;
+        if (!CourseKey::TryFind(courseNumber, key)) {
+            return nullptr;
+        }
+        auto found = courses.find(key);
+        return found != courses.end() ? &found->second : nullptr;
+    }
+
+    void ForEachInOrder(const Visitor& visit) const override {
+        for (const auto& entry : courses) {
+            visit(entry.second);
+        }
+    }
+
+    size_t FindByPrefix(string_view prefix, const Visitor& visit) const override {
+        CourseKeyBound start(prefix);
+        return VisitPrefixRun(courses.lower_bound(start), courses.end(), start.Text(), Value, visit);
+    }
+
+    size_t FindInRange(string_view first, string_view last, const Visitor& visit) const override {
+        CourseKeyBound lower(first), upper(last);
+        return VisitRangeRun(courses.lower_bound(lower), courses.end(), upper, Value, visit);
+    }
+
+    size_t Size() const override {
+        return courses.size();
+    }
+
+    void Clear() override {
+        courses.clear();
+        arena.Release();
+    }
+
+    // Everything the arena holds besides the courses and their long
+    // prerequisite lists is tree nodes: links, colour and the key copy
+    MemoryUsage GetMemoryUsage() const override {
+        MemoryUsage usage;
+        usage.courseRecords = courses.size() * sizeof(Course);
+        for (const auto& entry : courses) {
+            usage.prerequisites += entry.second.prerequisites.HeapBytes();
+        }
+        usage.nodeOverhead = arena.SmallBytes() + arena.LargeBytes() - usage.courseRecords - usage.prerequisites;
+        usage.allocatorSlack = arena.SlackBytes();
+        return usage;
+    }
+};
+
+// Courses in a B+tree: logarithmic lookups like the BST, but range and
+// prefix scans walk contiguous leaf arrays instead of chasing a pointer
+// per course
+class BPlusTreeCatalogStore : public CatalogStore {
+private:
+    BPlusTree tree;
+
+    static const Course& Self(const Course& c) {
+        return c;
+    }
+
+public:
+    const char* Name() const override {
+        return "B+tree";
+    }
+
+    void Insert(const Course& course) override {
+        if (!tree.Insert(course)) {
+            cout << "Warning: Duplicate course '" << course.courseNumber << "' found. Skipping duplicate." << endl;
+        }
+    }
+
+    const Course* Search(string_view courseNumber) const override {
+        return tree.Search(courseNumber);
+    }
+
+    void ForEachInOrder(const Visitor& visit) const override {
+        for (const Course& course : tree) {
+            visit(course);
+        }
+    }
+
+    size_t FindByPrefix(string_view prefix, const Visitor& visit) const override {
+        CourseKeyBound start(prefix);
+        return VisitPrefixRun(tree.LowerBound(start), tree.end(), start.Text(), Self, visit);
+    }
+
+    size_t FindInRange(string_view first, string_view last, const Visitor& visit) const override {
+        auto range = tree.Range(CourseKeyBound(first), CourseKeyBound(last));
+        size_t matches = 0;
+        for (auto it = range.first; it != range.second; ++it, ++matches) {
+            visit(*it);
+        }
+        return matches;
+    }
+
+    size_t Size() const override {
+        return tree.Size();
+    }
+
+    void Clear() override {
+        tree.Clear();
+    }
+
+    void PrintStatistics() const override {
+        cout << "\nCourses: " << tree.Size() << endl;
+        cout << "Storage: " << Name() << ", height " << tree.Height() << ", "
+             << tree.LeafCount() << " leaves, " << tree.InnerCount() << " inner nodes\n" << endl;
+    }
+
+    MemoryUsage GetMemoryUsage() const override {
+        return tree.GetMemoryUsage();
+    }
+};
+
+// The open-addressing HashTable behind the store interface. Only this
+// layout supports the frozen mode, the Bloom filter and the prefix trie.
+// With SipHasher (--seeded-hash) the slot of each key depends on a secret
+// per-process key, so a crafted catalog cannot force collisions.
+template <typename Hasher = SplitMixHasher>
+class BasicHashCatalogStore : public CatalogStore {
+private:
+    static constexpr bool kSeeded = is_same<Hasher, SipHasher>::value;
+
+    BasicHashTable<Hasher> table;
+
+public:
+    const char* Name() const override {
+        if (table.IsFrozen()) {
+            return kSeeded ? "frozen seeded perfect hash" : "frozen perfect hash";
+        }
+        return kSeeded ? "seeded hash table" : "hash table";
+    }
+
+    void Insert(const Course& course) override {
+        table.Insert(course);
+    }
+
+    const Course* Search(string_view courseNumber) const override {
+        return table.Search(courseNumber);
+    }
+
+    void ForEachInOrder(const Visitor& visit) const override {
+        table.ForEachInOrder(visit);
+    }
+
+    size_t FindByPrefix(string_view prefix, const Visitor& visit) const override {
+        return table.FindByPrefix(prefix, visit);
+    }
+
+    size_t FindInRange(string_view first, string_view last, const Visitor& visit) const override {
+        return table.ForEachInRange(CourseKeyBound(first), CourseKeyBound(last), visit);
+    }
+
+    size_t Size() const override {
+        return table.Size();
+    }
+
+    void Clear() override {
+        table.Clear();
+    }
+
+    void BeginBulkLoad() override {
+        table.BeginBulkLoad();
+    }
+
+    void EndBulkLoad() override {
+        table.EndBulkLoad();
+    }
+
+    // Finishes any rehash, so the table can be shared read-only and the
+    // frozen array, Bloom filter and prefix index are all built from one
+    // settled slot array, then freezes and adds the filter and index as asked
+    void FinishLoading(const LoadOptions& options) override {
+        table.FinishRehash();
+        if (options.freezeCatalog) {
+            auto start = chrono::steady_clock::now();
+            bool frozen = table.Freeze();
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            if (frozen) {
+                cout << "Perfect hash built for " << table.Size() << " courses in "
+                     << elapsed.count() << " ms." << endl;
+            }
+            else {
+                cout << "Warning: No perfect hash found for " << table.Size()
+                     << " courses; keeping the open-addressing table." << endl;
+            }
+        }
+
+        table.EnableNegativeLookupFilter(options.bloomFalsePositiveRate);
+        table.BuildPrefixIndex();
+    }
+
+    // Adds slot usage and, when a negative-lookup filter is enabled, how
+    // often it has answered a search without probing the table
+    void PrintStatistics() const override {
+        cout << "\nCourses: " << table.Size() << endl;
+        cout << "Storage: " << Name() << ", " << table.BucketCount() << " slots, load factor "
+             << fixed << setprecision(2) << table.LoadFactor() << defaultfloat << endl;
+
+        const BlockedBloomFilter& filter = table.NegativeLookupFilter();
+        if (filter.Empty()) {
+            cout << "Negative-lookup filter: off\n" << endl;
+            return;
+        }
+
+        LookupStatistics stats = table.GetLookupStatistics();
+        cout << "Negative-lookup filter: " << filter.BitCount() / 8 << " bytes, "
+             << filter.ProbeCount() << " probes per key" << endl;
+        cout << "  Rejected by filter: " << stats.rejectedByFilter << endl;
+        cout << "  Passed to table:    " << stats.passedFilter << endl;
+        cout << "  False positives:    " << stats.falsePositives << "\n" << endl;
+    }
+
+    MemoryUsage GetMemoryUsage() const override {
+        return table.GetMemoryUsage();
+    }
+
+    const BasicHashTable<Hasher>& Table() const {
+        return table;
+    }
+};
+
+using HashCatalogStore = BasicHashCatalogStore<>;
+using SeededHashCatalogStore = BasicHashCatalogStore<SipHasher>;
+
+// The RobinHoodHashTable behind the store interface: the layout for
+// catalogs edited one course at a time. Update and Remove change the table
+// in place; UpdateCourse and RemoveCourse call them when no reader holds a
+// snapshot of the catalog, and otherwise edit a copy (WithUpdated,
+// WithRemoved) that is published in the original's place. A set of the
+// stored course numbers keeps the courses in order, so listings and prefix
+// and range queries walk it instead of sorting the table.
+class RobinHoodCatalogStore : public CatalogStore {
+private:
+    RobinHoodHashTable<> table;
+    set<CourseKey, less<>> order;  // every stored course number
+
+    // The stored course for a key taken from order
+    auto CourseAt() const {
+        return [this](CourseKey key) -> const Course& { return *table.Find(key); };
+    }
+
+public:
+    const char* Name() const override {
+        return "Robin Hood hash table";
+    }
+
+    void Insert(const Course& course) override {
+        if (table.Insert(course)) {
+            order.insert(course.courseNumber);
+        }
+    }
+
+    const Course* Search(string_view courseNumber) const override {
+        return table.Search(courseNumber);
+    }
+
+    void ForEachInOrder(const Visitor& visit) const override {
+        for (CourseKey key : order) {
+            visit(*table.Find(key));
+        }
+    }
+
+    size_t FindByPrefix(string_view prefix, const Visitor& visit) const override {
+        CourseKeyBound start(prefix);
+        return VisitPrefixRun(order.lower_bound(start), order.end(), start.Text(), CourseAt(), visit);
+    }
+
+    size_t FindInRange(string_view first, string_view last, const Visitor& visit) const override {
+        CourseKeyBound lower(first), upper(last);
+        return VisitRangeRun(order.lower_bound(lower), order.end(), upper, CourseAt(), visit);
+    }
+
+    size_t Size() const override {
+        return table.Size();
+    }
+
+    void Clear() override {
+        table.Clear();
+        order.clear();
+    }
+
+    void PrintStatistics() const override {
+        cout << "\nCourses: " << table.Size() << endl;
+        cout << "Storage: " << Name() << ", " << table.BucketCount() << " slots, load factor "
+             << fixed << setprecision(2) << table.LoadFactor() << defaultfloat << "\n" << endl;
+    }
+
+    // The table plus the ordered set, counted as an index: about one tree
+    // node (key, three links and a color) per course
+    MemoryUsage GetMemoryUsage() const override {
+        MemoryUsage usage = table.GetMemoryUsage();
+        usage.indexes = order.size() * (sizeof(CourseKey) + 4 * sizeof(void*));
+        return usage;
+    }
+
+    // Adds course, or replaces the stored course with the same number, in
+    // place. Returns true when the course was new.
+    bool Update(const Course& course) {
+        bool added = table.Upsert(course);
+        if (added) {
+            order.insert(course.courseNumber);
+        }
+        return added;
+    }
+
+    // Removes a course in place. Returns false when it was not stored.
+    bool Remove(string_view courseNumber) {
+        CourseKey key;
+        if (!CourseKey::TryFind(courseNumber, key) || !table.Remove(courseNumber)) {
+            return false;
+        }
+        order.erase(key);
+        return true;
+    }
+
+    // A copy of this catalog with course added or replaced
+    shared_ptr<RobinHoodCatalogStore> WithUpdated(const Course& course) const {
+        auto next = make_shared<RobinHoodCatalogStore>(*this);
+        next->Update(course);
+        return next;
+    }
+
+    // A copy of this catalog without the given course (null when it is not
+    // stored)
+    shared_ptr<RobinHoodCatalogStore> WithRemoved(string_view courseNumber) const {
+        if (table.Search(courseNumber) == nullptr) {
+            return nullptr;
+        }
+        auto next = make_shared<RobinHoodCatalogStore>(*this);
+        next->Remove(courseNumber);
+        return next;
+    }
+};
+
+// Department of a course number: its leading letters, as a view into
+// courseNumber in their original letter case ("csci" for " csci200").
+// Numbers that start with a digit have none ("").
+string_view DepartmentView(string_view courseNumber) {
+    courseNumber = TrimView(courseNumber);
+    size_t length = 0;
+    while (length < courseNumber.size() && isalpha(static_cast<unsigned char>(courseNumber[length]))) {
+        ++length;
+    }
+    return courseNumber.substr(0, length);
+}
+
+// Department of a course number, upper-cased ("CSCI" for "csci200")
+string DepartmentOf(string_view courseNumber) {
+    return ToUpper(string(DepartmentView(courseNumber)));
+}
+
+// Orders department names by their upper-cased letters, so a department
+// spelled in any letter case finds its entry without being copied
+struct DepartmentLess {
+    using is_transparent = void;
+
+    bool operator()(string_view a, string_view b) const {
+        return lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+            return toupper(static_cast<unsigned char>(x)) < toupper(static_cast<unsigned char>(y));
+            });
+    }
+};
+
+// Two-level catalog: a directory of departments, each holding its own
+// independently sized hash table. Work on one department (a lookup, a
+// listing, a reload) touches only that department's table and lock.
+//
+// Partitions are shared between copies of the store, so WithDepartment
+// can publish a catalog with one department reloaded while every other
+// department's memory stays exactly where it was. A shared partition is
+// never edited in place: the copies WithDepartment makes are read-only,
+// and replacing a department installs a new partition in the copy.
+class PartitionedCatalogStore : public CatalogStore {
+private:
+    struct Partition {
+        mutable shared_mutex lock;  // readers share it; Insert (loading only) takes it alone
+        unique_ptr<HashCatalogStore> courses;
+        CourseKey lowest;           // key range, to tell whether partitions
+        CourseKey highest;          // can be listed one after another
+
+        explicit Partition(unique_ptr<HashCatalogStore> loaded) : courses(std::move(loaded)) {
+            bool first = true;
+            courses->ForEachInOrder([&](const Course& c) {
+                if (first) lowest = c.courseNumber;
+                highest = c.courseNumber;
+                first = false;
+                });
+        }
+    };
+
+    map<string, shared_ptr<Partition>, DepartmentLess> partitions;  // by upper-cased department
+    mutable shared_mutex directoryLock;                              // guards the map itself
+    bool bulkLoading = false;
+
+    // Partitions in department order, for a query that may span several
+    vector<shared_ptr<const Partition>> AllPartitions() const {
+        shared_lock<shared_mutex> guard(directoryLock);
+        vector<shared_ptr<const Partition>> all;
+        for (const auto& entry : partitions) {
+            all.push_back(entry.second);
+        }
+        return all;
+    }
+
+    shared_ptr<const Partition> FindPartition(string_view department) const {
+        shared_lock<shared_mutex> guard(directoryLock);
+        auto found = partitions.find(department);
+        return found != partitions.end() ? found->second : nullptr;
+    }
+
+    // Runs query(courses, visitor) on each partition and passes the results
+    // on in course-number order. Departments usually cover disjoint key
+    // ranges, so their results are streamed one partition after another;
+    // otherwise (e.g. "CS-1" sorts before "CS1") they are merged by a sort.
+    template <typename Query>
+    size_t VisitInOrder(const vector<shared_ptr<const Partition>>& parts, Query query, const Visitor& visit) const {
+        bool disjoint = true;
+        for (size_t i = 1; i < parts.size() && disjoint; ++i) {
+            disjoint = parts[i - 1]->highest < parts[i]->lowest;
+        }
+
+        size_t matches = 0;
+        if (disjoint) {
+            for (const auto& part : parts) {
+                shared_lock<shared_mutex> guard(part->lock);
+                matches += query(*part->courses, visit);
+            }
+            return matches;
+        }
+
+        vector<const Course*> merged;
+        for (const auto& part : parts) {
+            shared_lock<shared_mutex> guard(part->lock);
+            matches += query(*part->courses, [&](const Course& c) { merged.push_back(&c); });
+        }
+        stable_sort(merged.begin(), merged.end(), [](const Course* a, const Course* b) {
+            return a->courseNumber < b->courseNumber;
+            });
+        for (const Course* course : merged) {
+            visit(*course);
+        }
+        return matches;
+    }
+
+    // Copies the directory; the partitions themselves are shared. Only
+    // WithDepartment makes copies, and hands them out read-only.
+    PartitionedCatalogStore(const PartitionedCatalogStore& other) : CatalogStore(other) {
+        shared_lock<shared_mutex> guard(other.directoryLock);
+        partitions = other.partitions;
+    }
+
+    // Installs courses as the whole of department (dropping the department
+    // if courses is empty). The old partition is released, not edited, so
+    // copies of the store that share it are unaffected.
+    void ReplaceDepartment(string_view department, unique_ptr<HashCatalogStore> courses) {
+        string name = ToUpper(string(department));
+        shared_ptr<Partition> replacement;
+        if (courses->Size() != 0) {
+            replacement = make_shared<Partition>(std::move(courses));
+        }
+
+        unique_lock<shared_mutex> guard(directoryLock);
+        if (replacement == nullptr) {
+            partitions.erase(name);
+        }
+        else {
+            partitions[name] = std::move(replacement);
+        }
+    }
+
+public:
+    PartitionedCatalogStore() = default;
+
+    const char* Name() const override {
+        return "partitioned by department";
+    }
+
+    void Insert(const Course& course) override {
+        string department = DepartmentOf(course.courseNumber.ToString());
+
+        shared_ptr<Partition> partition;
+        {
+            unique_lock<shared_mutex> guard(directoryLock);
+            shared_ptr<Partition>& slot = partitions[department];
+            if (slot == nullptr) {
+                slot = make_shared<Partition>(make_unique<HashCatalogStore>());
+                slot->lowest = slot->highest = course.courseNumber;
+                if (bulkLoading) slot->courses->BeginBulkLoad();
+            }
+            partition = slot;
+        }
+
+        unique_lock<shared_mutex> guard(partition->lock);
+        size_t before = partition->courses->Size();
+        partition->courses->Insert(course);
+        if (partition->courses->Size() != before) {
+            if (course.courseNumber < partition->lowest) partition->lowest = course.courseNumber;
+            if (partition->highest < course.courseNumber) partition->highest = course.courseNumber;
+        }
+    }
+
+    // The returned course stays valid while the caller holds this catalog.
+    // The partition lock only orders the lookup against a load still
+    // inserting; once the catalog is shared its partitions never change.
+    const Course* Search(string_view courseNumber) const override {
+        shared_ptr<const Partition> partition = FindPartition(DepartmentView(courseNumber));
+        if (partition == nullptr) {
+            return nullptr;
+        }
+        shared_lock<shared_mutex> guard(partition->lock);
+        return partition->courses->Search(courseNumber);
+    }
+
+    void ForEachInOrder(const Visitor& visit) const override {
+        VisitInOrder(AllPartitions(), [](const HashCatalogStore& courses, const Visitor& v) {
+            courses.ForEachInOrder(v);
+            return courses.Size();
+            }, visit);
+    }
+
+    // A prefix that goes past the department letters ("CSCI2") names one
+    // department; a letters-only prefix ("CS") may cover several
+    size_t FindByPrefix(string_view prefix, const Visitor& visit) const override {
+        string department = DepartmentOf(prefix);
+        vector<shared_ptr<const Partition>> parts;
+        if (department.size() < TrimView(prefix).size()) {
+            shared_ptr<const Partition> partition = FindPartition(department);
+            if (partition != nullptr) parts.push_back(partition);
+        }
+        else {
+            shared_lock<shared_mutex> guard(directoryLock);
+            for (auto it = partitions.lower_bound(department);
+                 it != partitions.end() && it->first.compare(0, department.size(), department) == 0; ++it) {
+                parts.push_back(it->second);
+            }
+        }
+        return VisitInOrder(parts, [&](const HashCatalogStore& courses, const Visitor& v) {
+            return courses.FindByPrefix(prefix, v);
+            }, visit);
+    }
+
+    // Only partitions whose key range overlaps [first, last] are searched
+    size_t FindInRange(string_view first, string_view last, const Visitor& visit) const override {
+        CourseKeyBound lower(first), upper(last);
+        vector<shared_ptr<const Partition>> parts;
+        for (const auto& part : AllPartitions()) {
+            if (!(part->highest < lower) && !(upper < part->lowest)) {
+                parts.push_back(part);
+            }
+        }
+        return VisitInOrder(parts, [&](const HashCatalogStore& courses, const Visitor& v) {
+            return courses.FindInRange(first, last, v);
+            }, visit);
+    }
+
+    size_t Size() const override {
+        size_t total = 0;
+        for (const auto& part : AllPartitions()) {
+            shared_lock<shared_mutex> guard(part->lock);
+            total += part->courses->Size();
+        }
+        return total;
+    }
+
+    void Clear() override {
+        unique_lock<shared_mutex> guard(directoryLock);
+        partitions.clear();
+    }
+
+    void BeginBulkLoad() override {
+        bulkLoading = true;
+        for (const auto& part : AllPartitions()) {
+            part->courses->BeginBulkLoad();
+        }
+    }
+
+    void EndBulkLoad() override {
+        bulkLoading = false;
+        for (const auto& part : AllPartitions()) {
+            part->courses->EndBulkLoad();
+        }
+    }
+
+    void FinishLoading(const LoadOptions& options) override {
+        for (const auto& part : AllPartitions()) {
+            part->courses->FinishLoading(options);
+        }
+    }
+
+    // Departments in the catalog, in order
+    vector<string> Departments() const {
+        shared_lock<shared_mutex> guard(directoryLock);
+        vector<string> names;
+        for (const auto& entry : partitions) {
+            names.push_back(entry.first);
+        }
+        return names;
+    }
+
+    // Visits one department's courses in order; returns how many there were
+    size_t ForEachInDepartment(string_view department, const Visitor& visit) const {
+        shared_ptr<const Partition> partition = FindPartition(department);
+        if (partition == nullptr) {
+            return 0;
+        }
+        shared_lock<shared_mutex> guard(partition->lock);
+        partition->courses->ForEachInOrder(visit);
+        return partition->courses->Size();
+    }
+
+    // A read-only copy of this catalog with one department replaced; the
+    // other departments are shared with this one, not copied
+    shared_ptr<const PartitionedCatalogStore> WithDepartment(string_view department,
+                                                             unique_ptr<HashCatalogStore> courses) const {
+        shared_ptr<PartitionedCatalogStore> next(new PartitionedCatalogStore(*this));
+        next->ReplaceDepartment(department, std::move(courses));
+        return next;
+    }
+
+    void PrintStatistics() const override {
+        vector<shared_ptr<const Partition>> parts = AllPartitions();
+        vector<string> names = Departments();
+        cout << "\nCourses: " << Size() << endl;
+        cout << "Storage: " << Name() << ", " << parts.size() << " departments" << endl;
+        for (size_t i = 0; i < parts.size() && i < names.size(); ++i) {
+            shared_lock<shared_mutex> guard(parts[i]->lock);
+            const HashTable& table = parts[i]->courses->Table();
+            cout << "  " << left << setw(10) << (names[i].empty() ? "(none)" : names[i]) << right
+                 << setw(8) << table.Size() << " courses" << setw(8) << table.BucketCount() << " slots" << endl;
+        }
+        cout << "\n";
+    }
+
+    // The departments' tables plus the directory, counted as node overhead:
+    // about one map node, partition and store object per department
+    MemoryUsage GetMemoryUsage() const override {
+        MemoryUsage usage;
+        size_t departments = 0;
+        for (const auto& part : AllPartitions()) {
+            shared_lock<shared_mutex> guard(part->lock);
+            usage += part->courses->GetMemoryUsage();
+            ++departments;
+        }
+        usage.nodeOverhead += departments * (sizeof(pair<const string, shared_ptr<Partition>>) + 4 * sizeof(void*)
+            + sizeof(Partition) + sizeof(HashCatalogStore));
+        return usage;
+    }
+
+    // A department reloaded on its own keeps its titles in its own pool
+    size_t TitleBytes() const override {
+        size_t bytes = CatalogStore::TitleBytes();
+        for (const auto& part : AllPartitions()) {
+            bytes += part->courses->TitleBytes();
+        }
+        return bytes;
+    }
+};
+
+// Creates an empty store of the given layout; seededHash picks SipHash for
+// the hash layout
+shared_ptr<CatalogStore> MakeCatalogStore(StorageBackend backend, bool seededHash = false) {
+    switch (backend) {
+    case StorageBackend::Vector:
+        return make_shared<VectorCatalogStore>();
+    case StorageBackend::Tree:
+        return make_shared<TreeCatalogStore>();
+    case StorageBackend::BPlusTree:
+        return make_shared<BPlusTreeCatalogStore>();
+    case StorageBackend::Partitioned:
+        return make_shared<PartitionedCatalogStore>();
+    case StorageBackend::RobinHood:
+        return make_shared<RobinHoodCatalogStore>();
+    case StorageBackend::Hash:
+    default:
+        if (seededHash) {
+            return make_shared<SeededHashCatalogStore>();
+        }
+        return make_shared<HashCatalogStore>();
+    }
+}
+
+// ===============================
+// CATALOG SNAPSHOTS
+// ===============================
+
+// Holds the catalog currently being served. A load builds a complete new
+// store off to the side and publishes it with one pointer swap, so readers
+// only ever see a whole catalog: never an empty or half-loaded one. A
+// reader's snapshot is reference counted, so a reader that started before
+// a reload keeps the old catalog alive until it finishes. The lock is held
+// only to copy or swap the pointer, or for an in-place edit (EditInPlace).
+class CatalogHandle {
+private:
+    mutable shared_mutex lock;
+    shared_ptr<const CatalogStore> current;
+
+public:
+    // The catalog being served, or null before the first successful load
+    shared_ptr<const CatalogStore> Snapshot() const {
+        shared_lock<shared_mutex> guard(lock);
+        return current;
+    }
+
+    // Replaces the served catalog; readers holding the old one are unaffected
+    void Publish(shared_ptr<const CatalogStore> next) {
+        unique_lock<shared_mutex> guard(lock);
+        current = std::move(next);
+    }
+
+    // Calls edit on the served catalog, as a Store, when no reader holds a
+    // snapshot of it, so the edit can change it in place; no snapshot can be
+    // taken until edit returns. Returns false, without calling edit, when a
+    // snapshot is held or the catalog is not a Store.
+    template <typename Store, typename Edit>
+    bool EditInPlace(Edit edit) {
+        unique_lock<shared_mutex> guard(lock);
+        if (current == nullptr || current.use_count() != 1 || dynamic_cast<const Store*>(current.get()) == nullptr) {
+            return false;
+        }
+        // Stores are created mutable and only handed out as const
+        edit(const_cast<Store&>(static_cast<const Store&>(*current)));
+        return true;
+    }
+};
+
+// ===============================
+// CORE FUNCTIONALITY
+// ===============================
+
+// Builds a course from the fields of one CSV line: number, title, then
+// any prerequisites (empty fields are ignored)
+template <typename Token>
+Course CourseFromTokens(const vector<Token>& tokens) {
+    Course course;
+    course.courseNumber = CourseKey::FromString(tokens[0]);
+    course.courseTitle = CourseTitle::FromString(tokens[1]);
+
+    for (size_t i = 2; i < tokens.size(); ++i) {
+        if (!string_view(tokens[i]).empty()) {
+            course.prerequisites.push_back(CourseKey::FromString(tokens[i]));
+        }
+    }
+    return course;
+}
+
+// One non-blank line of a chunk as parsed by a load worker: a course to
+// store, or an invalid line to warn about
+struct ParsedLine {
+    int lineNumber;  // within its chunk
+    bool valid;
+    Course course;
+};
+
+struct ParsedChunk {
+    vector<ParsedLine> lines;
+    int lineCount = 0;  // lines in the chunk, blank ones included
+};
+
+// Parses one chunk of a CSV file into courses (interning their keys and
+// titles), leaving out other departments when options name one
+ParsedChunk ParseChunk(string_view chunk, const LoadOptions& options) {
+    ParsedChunk parsed;
+    parsed.lineCount = ForEachCSVLine(chunk, [&](int lineNumber, const vector<string_view>& tokens) {
+        if (tokens.size() < 2) {
+            parsed.lines.push_back(ParsedLine{ lineNumber, false, Course() });
+            return;
+        }
+
+        if (options.filterDepartment && DepartmentOf(tokens[0]) != options.department) {
+            return;
+        }
+
+        parsed.lines.push_back(ParsedLine{ lineNumber, true, CourseFromTokens(tokens) });
+        });
+    return parsed;
+}
+
+// Loads courses from a CSV file into a catalog store, then lets the store
+// apply the load options that concern its layout.
+//
+// The mapped file is cut into newline-aligned chunks that a pool of
+// workers parses in parallel, while this thread merges finished chunks
+// into the store strictly in file order. Inserts and warnings therefore
+// happen exactly as in a single-threaded load: the first of several
+// courses with one number wins, and line numbers count from the start of
+// the file. Workers stay at most a few chunks ahead of the merge, which
+// bounds the parsed courses held at once.
+bool LoadCourses(const string& filename, CatalogStore& courseTable, const LoadOptions& options = LoadOptions()) {
+    static constexpr size_t kChunkBytes = 1024 * 1024;
+    static constexpr size_t kChunksAheadPerWorker = 4;
+
+    MappedFile file;
+    if (!file.Open(filename)) {
+        cout << "Error: Cannot open file '" << filename << "'. Please check the file and try again.\n" << endl;
+        return false;
+    }
+
+    courseTable.Clear();  // Clear any existing data
+    courseTable.ResetTitles();  // and its titles
+    TitleScope titles(courseTable.Titles());
+    courseTable.BeginBulkLoad();
+
+    // Lines and fields are views into the mapped file; characters are
+    // copied only when a course is interned and stored
+    vector<string_view> chunks = SplitAtNewlines(file.View(), kChunkBytes);
+    unsigned threads = options.loadThreads != 0 ? options.loadThreads : max(1u, thread::hardware_concurrency());
+    size_t workerCount = min<size_t>(threads, chunks.size());
+    if (workerCount < 2) workerCount = 0;  // parse on this thread, no pool
+    size_t window = max<size_t>(1, workerCount * kChunksAheadPerWorker);
+
+    vector<ParsedChunk> parsed(chunks.size());
+    vector<bool> ready(chunks.size(), false);
+    size_t nextChunk = 0;  // next chunk a worker will take
+    size_t merged = 0;     // chunks already merged into the store
+    mutex lock;
+    condition_variable changed;
+
+    vector<thread> workers;
+    for (size_t w = 0; w < workerCount; ++w) {
+        workers.emplace_back([&]() {
+            TitleScope workerTitles(courseTable.Titles());
+            unique_lock<mutex> guard(lock);
+            while (true) {
+                changed.wait(guard, [&]() { return nextChunk >= chunks.size() || nextChunk < merged + window; });
+                if (nextChunk >= chunks.size()) return;
+                size_t index = nextChunk++;
+
+                guard.unlock();
+                ParsedChunk result = ParseChunk(chunks[index], options);
+                guard.lock();
+                parsed[index] = std::move(result);
+                ready[index] = true;
+                changed.notify_all();
+            }
+            });
+    }
+
+    int firstLine = 0;  // lines before the chunk being merged
+    for (size_t index = 0; index < chunks.size(); ++index) {
+        ParsedChunk chunk;
+        if (workerCount == 0) {
+            chunk = ParseChunk(chunks[index], options);
+        }
+        else {
+            unique_lock<mutex> guard(lock);
+            changed.wait(guard, [&]() { return ready[index]; });
+            chunk = std::move(parsed[index]);
+            merged = index + 1;
+            changed.notify_all();
+        }
+
+        for (const ParsedLine& line : chunk.lines) {
+            if (!line.valid) {
+                cout << "Warning (line " << firstLine + line.lineNumber << "): Skipping invalid line." << endl;
+                continue;
+            }
+            courseTable.Insert(line.course);
+        }
+        firstLine += chunk.lineCount;
+    }
+
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    file.Close();
+    courseTable.EndBulkLoad();
+    courseTable.FinishLoading(options);
+
+    cout << "Courses loaded successfully.\n" << endl;
+    return true;
+}
+
+// Loads courses into a new store of the chosen layout and publishes it as
+// the catalog snapshot. If the load fails, the catalog already being served
+// stays in place.
+bool LoadCourses(const string& filename, CatalogHandle& catalog, const LoadOptions& options = LoadOptions()) {
+    shared_ptr<CatalogStore> store = MakeCatalogStore(options.backend, options.seededHash);
+    if (!LoadCourses(filename, *store, options)) {
+        return false;
+    }
+
+    catalog.Publish(std::move(store));
+    return true;
+}
+
+// Reloads one department of a partitioned catalog from a CSV file, reading
+// only that department's lines. The other departments are shared with the
+// catalog being served, so their memory is not touched or copied.
+bool ReloadDepartment(const string& filename, const string& department, CatalogHandle& catalog, LoadOptions options) {
+    auto current = dynamic_pointer_cast<const PartitionedCatalogStore>(catalog.Snapshot());
+    if (current == nullptr) {
+        cout << "Reloading one department needs the partitioned layout (--store partitioned).\n" << endl;
+        return false;
+    }
+
+    // A blank entry, or one with no leading letters ("101"), names no
+    // department; loading it would pull in the whole file
+    options.department = DepartmentOf(department);
+    if (options.department.empty()) {
+        cout << "Error: '" << Trim(department) << "' does not name a department (e.g. CSCI).\n" << endl;
+        return false;
+    }
+    options.filterDepartment = true;
+
+    auto courses = make_unique<HashCatalogStore>();
+    if (!LoadCourses(filename, *courses, options)) {
+        return false;
+    }
+
+    cout << courses->Size() << " courses now in department '" << options.department << "'.\n" << endl;
+    catalog.Publish(current->WithDepartment(options.department, std::move(courses)));
+    return true;
+}
+
+// The catalog being served when it can be edited one course at a time
+shared_ptr<const RobinHoodCatalogStore> EditableCatalog(const CatalogHandle& catalog) {
+    auto current = dynamic_pointer_cast<const RobinHoodCatalogStore>(catalog.Snapshot());
+    if (current == nullptr) {
+        cout << "Editing single courses needs the Robin Hood layout (--store robinhood).\n" << endl;
+    }
+    return current;
+}
+
+// Adds a course, or replaces the one with the same number, from a line in
+// the CSV format (number, title, prerequisites). The served catalog is
+// edited in place unless a reader holds a snapshot of it, in which case an
+// edited copy is published instead.
+bool UpdateCourse(const string& line, CatalogHandle& catalog) {
+    auto current = EditableCatalog(catalog);
+    if (current == nullptr) {
+        return false;
+    }
+
+    vector<string> tokens = SplitCSV(line);
+    if (tokens.size() < 2 || tokens[0].empty() || tokens[1].empty()) {
+        cout << "Error: A course needs at least a course number and a title.\n" << endl;
+        return false;
+    }
+
+    // The title joins the catalog's pool, which an edited copy shares
+    TitleScope titles(current->Titles());
+    Course course = CourseFromTokens(tokens);
+    bool added = false;
+    current.reset();  // our own snapshot would force a copy
+    if (!catalog.EditInPlace<RobinHoodCatalogStore>([&](RobinHoodCatalogStore& store) { added = store.Update(course); })) {
+        current = EditableCatalog(catalog);
+        added = current->Search(tokens[0]) == nullptr;
+        catalog.Publish(current->WithUpdated(course));
+    }
+    cout << "Course '" << course.courseNumber << "' " << (added ? "added" : "updated") << ".\n" << endl;
+    return true;
+}
+
+// Removes one course, in place or from a published copy as UpdateCourse does
+bool RemoveCourse(const string& courseNumber, CatalogHandle& catalog) {
+    if (EditableCatalog(catalog) == nullptr) {
+        return false;
+    }
+
+    bool removed = false;
+    if (!catalog.EditInPlace<RobinHoodCatalogStore>([&](RobinHoodCatalogStore& store) { removed = store.Remove(courseNumber); })) {
+        auto next = EditableCatalog(catalog)->WithRemoved(courseNumber);
+        if (next != nullptr) {
+            catalog.Publish(std::move(next));
+            removed = true;
+        }
+    }
+    if (!removed) {
+        cout << "Course '" << courseNumber << "' not found.\n" << endl;
+        return false;
+    }
+    cout << "Course '" << ToUpper(courseNumber) << "' removed.\n" << endl;
+    return true;
+}
+
+// Prints a sorted list of all courses (alphanumeric), streamed in order
+// from the store
+void PrintCourseList(const CatalogStore& courseTable) {
+    if (courseTable.Size() == 0) {
+        cout << "No courses loaded. Please load data first.\n" << endl;
+        return;
+    }
+
+    cout << "\nHere is a sample schedule:" << endl;
+    courseTable.ForEachInOrder([](const Course& c) {
+        cout << c.courseNumber << ", " << c.courseTitle << endl;
+        });
+    cout << "\n";
+}
+
+// Prints the prerequisite line shared by every catalog type
+template <typename Iterator>
+void PrintPrerequisites(Iterator first, Iterator last) {
+    if (first == last) {
+        cout << "Prerequisites: None\n" << endl;
+    }
+    else {
+        cout << "Prerequisites: ";
+        for (Iterator it = first; it != last; ++it) {
+            if (it != first) cout << ", ";
+            cout << *it;
+        }
+        cout << "\n" << endl;
+    }
+}
+
+// Prints detailed information for a specific course
+void PrintCourseInfo(const CatalogStore& courseTable, const string& query) {
+    const Course* course = courseTable.Search(query);
+
+    if (course == nullptr) {
+        cout << "Course not found.\n" << endl;
+        return;
+    }
+
+    cout << "\n" << course->courseNumber << ", " << course->courseTitle << endl;
+    PrintPrerequisites(course->prerequisites.begin(), course->prerequisites.end());
+}
+
+// Strips the optional trailing wildcard from a prefix query ("CSCI2*")
+string_view PrefixOfQuery(string_view query) {
+    query = TrimView(query);
+    if (!query.empty() && query.back() == '*') {
+        query.remove_suffix(1);
+    }
+    return query;
+}
+
+// Prints every course whose number starts with the given prefix
+void PrintCoursesByPrefix(const CatalogStore& courseTable, const string& query) {
+    string_view prefix = PrefixOfQuery(query);
+    size_t matches = courseTable.FindByPrefix(prefix, [](const Course& c) {
+        cout << c.courseNumber << ", " << c.courseTitle << endl;
+        });
+
+    if (matches == 0) {
+        cout << "No courses start with '" << prefix << "'." << endl;
+    }
+    cout << "\n";
+}
+
+// Prints every course numbered from first to last inclusive, in order
+void PrintCourseRange(const CatalogStore& courseTable, const string& first, const string& last) {
+    size_t matches = courseTable.FindInRange(first, last, [](const Course& c) {
+        cout << c.courseNumber << ", " << c.courseTitle << endl;
+        });
+
+    if (matches == 0) {
+        cout << "No courses between '" << NormalizeCourseNumber(first) << "' and '"
+             << NormalizeCourseNumber(last) << "'." << endl;
+    }
+    cout << "\n";
+}
+
+// Prints the size and layout details of the catalog store
+void PrintCatalogStatistics(const CatalogStore& courseTable) {
+    courseTable.PrintStatistics();
+}
+
+// Prints one line of the memory report: bytes, share of the total and
+// bytes per course
+void PrintMemoryLine(const char* label, size_t bytes, size_t total, size_t courses) {
+    cout << "  " << left << setw(22) << label << right << fixed << setprecision(1)
+         << setw(12) << bytes / 1024.0 << " KB" << setw(8) << (total == 0 ? 0.0 : 100.0 * bytes / total) << " %"
+         << setw(10) << (courses == 0 ? 0.0 : static_cast<double>(bytes) / courses) << " B/course"
+         << defaultfloat << endl;
+}
+
+// Prints the bytes the catalog holds by category, including the shared
+// pool of long course numbers and the catalog's title pool
+void PrintMemoryUsage(const CatalogStore& courseTable) {
+    MemoryUsage usage = courseTable.GetMemoryUsage();
+    usage.keyStrings = OverflowKeyBytes();
+    usage.titles = courseTable.TitleBytes();
+
+    size_t total = usage.Total();
+    size_t courses = courseTable.Size();
+    cout << "\nMemory usage of the " << courseTable.Name() << " (" << courses << " courses)" << endl;
+    PrintMemoryLine("Course records", usage.courseRecords, total, courses);
+    PrintMemoryLine("Bucket array", usage.bucketArray, total, courses);
+    PrintMemoryLine("Node overhead", usage.nodeOverhead, total, courses);
+    PrintMemoryLine("Prerequisite lists", usage.prerequisites, total, courses);
+    PrintMemoryLine("Indexes", usage.indexes, total, courses);
+    PrintMemoryLine("Allocator slack", usage.allocatorSlack, total, courses);
+    PrintMemoryLine("Course-number strings", usage.keyStrings, total, courses);
+    PrintMemoryLine("Titles", usage.titles, total, courses);
+    PrintMemoryLine("Total", total, total, courses);
+    cout << "(Course-number strings are shared by every loaded catalog.)\n" << endl;
+}
+
+// Loads a CSV file with the given options and prints its memory report
+bool RunMemoryReport(const string& filename, const LoadOptions& options) {
+    shared_ptr<CatalogStore> store = MakeCatalogStore(options.backend, options.seededHash);
+    if (!LoadCourses(filename, *store, options)) {
+        return false;
+    }
+    PrintMemoryUsage(*store);
+    return true;
+}
+
+#ifdef ADVISING_EMBEDDED_CATALOG
+// Prints the compiled-in catalog, which is already stored in sorted order
+void PrintCourseList(const EmbeddedCatalog& catalog) {
+    cout << "\nHere is a sample schedule:" << endl;
+    for (const EmbeddedCourse& c : catalog) {
+        cout << c.courseNumber << ", " << c.courseTitle << endl;
+    }
+    cout << "\n";
+}
+
+// Prints detailed information for a course of the compiled-in catalog
+void PrintCourseInfo(const EmbeddedCatalog& catalog, const string& query) {
+    const EmbeddedCourse* course = catalog.Search(query);
+
+    if (course == nullptr) {
+        cout << "Course not found.\n" << endl;
+        return;
+    }
+
+    cout << "\n" << course->courseNumber << ", " << course->courseTitle << endl;
+    const char* const* first = kEmbeddedPrerequisites + course->firstPrerequisite;
+    PrintPrerequisites(first, first + course->prerequisiteCount);
+}
+
+// Prints every compiled-in course whose number starts with the given
+// prefix; the catalog is sorted, so the matches are one contiguous run
+void PrintCoursesByPrefix(const EmbeddedCatalog& catalog, const string& query) {
+    string prefix = ToUpper(string(PrefixOfQuery(query)));
+    const EmbeddedCourse* first = lower_bound(catalog.begin(), catalog.end(), prefix,
+        [](const EmbeddedCourse& c, const string& p) { return string_view(c.courseNumber) < p; });
+
+    size_t matches = 0;
+    for (const EmbeddedCourse* c = first; c != catalog.end(); ++c, ++matches) {
+        if (string_view(c->courseNumber).compare(0, prefix.size(), prefix) != 0) break;
+        cout << c->courseNumber << ", " << c->courseTitle << endl;
+    }
+
+    if (matches == 0) {
+        cout << "No courses start with '" << prefix << "'." << endl;
+    }
+    cout << "\n";
+}
+
+// Prints every compiled-in course numbered from first to last inclusive
+void PrintCourseRange(const EmbeddedCatalog& catalog, const string& first, const string& last) {
+    string lower = NormalizeCourseNumber(first);
+    string upper = NormalizeCourseNumber(last);
+    const EmbeddedCourse* start = lower_bound(catalog.begin(), catalog.end(), lower,
+        [](const EmbeddedCourse& c, const string& bound) { return string_view(c.courseNumber) < bound; });
+
+    size_t matches = 0;
+    for (const EmbeddedCourse* c = start; c != catalog.end(); ++c, ++matches) {
+        if (string_view(c->courseNumber) > upper) break;
+        cout << c->courseNumber << ", " << c->courseTitle << endl;
+    }
+
+    if (matches == 0) {
+        cout << "No courses between '" << lower << "' and '" << upper << "'." << endl;
+    }
+    cout << "\n";
+}
+
+// Prints the size of the compiled-in catalog
+void PrintCatalogStatistics(const EmbeddedCatalog& catalog) {
+    cout << "\nCourses: " << catalog.Size() << endl;
+    cout << "Storage: compiled-in perfect hash\n" << endl;
+}
+
+// The compiled-in catalog is read-only program data; only the course
+// records and the perfect-hash index have a fixed size to report
+void PrintMemoryUsage(const EmbeddedCatalog& catalog) {
+    size_t records = catalog.Size() * sizeof(EmbeddedCourse);
+    cout << "\nMemory usage of the compiled-in catalog (" << catalog.Size() << " courses)" << endl;
+    cout << "  Course records: " << records << " bytes, plus the string literals and index" << endl;
+    cout << "  No heap memory is used.\n" << endl;
+}
+#endif
+
+// Escapes text for use inside a C++ string literal
+string EscapeForCpp(const string& text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '\\' || c == '"') {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+// Writes a constant array of numbers, a dozen to a line
+template <typename Number>
+void WriteNumberArray(ostream& out, const char* type, const char* name, const vector<Number>& values) {
+    out << "constexpr " << type << " " << name << "[] = {";
+    for (size_t i = 0; i < values.size(); ++i) {
+        out << (i % 12 == 0 ? "\n    " : " ") << values[i] << ",";
+    }
+    out << "\n};\n";
+}
+
+// Turns a course CSV into a header for an embedded (kiosk) build. The CSV
+// goes through LoadCourses, so the generated catalog gets the same
+// validation and duplicate handling as an interactive load. The perfect
+// hash is built here and written out as tables, so the embedded build does
+// no search at compile time, whatever the size of the catalog.
+bool WriteEmbeddedCatalog(const string& csvFile, const string& headerFile) {
+    VectorCatalogStore courseTable;
+    if (!LoadCourses(csvFile, courseTable)) {
+        return false;
+    }
+
+    vector<Course> allCourses;
+    courseTable.ForEachInOrder([&](const Course& c) { allCourses.push_back(c); });
+    if (allCourses.empty()) {
+        cout << "Error: '" << csvFile << "' contains no courses to embed." << endl;
+        return false;
+    }
+
+    vector<uint64_t> hashes;
+    for (const auto& c : allCourses) {
+        hashes.push_back(EmbeddedHash(c.courseNumber.ToString()));
+    }
+    uint64_t seed = 0;
+    vector<uint32_t> pilots;
+    vector<size_t> positions;
+    if (!FindPerfectHash(hashes, kEmbeddedKeysPerPilot, seed, pilots, positions)) {
+        cout << "Error: Cannot build a perfect hash over the courses in '" << csvFile << "'." << endl;
+        return false;
+    }
+    vector<uint32_t> courseAt(allCourses.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        courseAt[positions[i]] = static_cast<uint32_t>(i);
+    }
+
+    ofstream header(headerFile);
+    if (!header.is_open()) {
+        cout << "Error: Cannot write file '" << headerFile << "'." << endl;
+        return false;
+    }
+
+    header << "// Generated by \"Advising Assistance Program --embed-catalog\" from " << csvFile << ".\n"
+           << "// Do not edit; regenerate it whenever the catalog changes.\n"
+           << "#pragma once\n\n";
+
+    header << "constexpr const char* kEmbeddedPrerequisites[] = {\n";
+    for (const auto& c : allCourses) {
+        for (const CourseKey& prerequisite : c.prerequisites) {
+            header << "    \"" << EscapeForCpp(prerequisite.ToString()) << "\",\n";
+        }
+    }
+    header << "    nullptr  // keeps the array non-empty\n};\n\n";
+
+    header << "constexpr EmbeddedCourse kEmbeddedCourses[] = {\n";
+    size_t firstPrerequisite = 0;
+    for (const auto& c : allCourses) {
+        header << "    { \"" << EscapeForCpp(c.courseNumber.ToString()) << "\", \""
+               << EscapeForCpp(c.courseTitle.ToString()) << "\", " << firstPrerequisite << ", "
+               << c.prerequisites.size() << " },\n";
+        firstPrerequisite += c.prerequisites.size();
+    }
+    header << "};\n\n";
+
+    header << "constexpr uint64_t kEmbeddedHashSeed = " << seed << ";\n\n";
+    WriteNumberArray(header, "uint32_t", "kEmbeddedPilots", pilots);
+    header << "\n";
+    WriteNumberArray(header, "uint32_t", "kEmbeddedCourseAt", courseAt);
+
+    cout << "Embedded " << allCourses.size() << " courses into '" << headerFile << "'." << endl;
+    return true;
+}
+
+// ===============================
+// BENCHMARKS
+// ===============================
+
+// Inserts every course into a table using one hasher, then times repeated
+// lookups of every course number and prints the probe-length distribution
+template <typename Hasher>
+void BenchmarkHasher(const vector<Course>& courses, const vector<string>& queries) {
+    BasicHashTable<Hasher> table;
+
+    auto start = chrono::steady_clock::now();
+    for (const auto& c : courses) {
+        table.Insert(c);
+    }
+    chrono::duration<double, nano> insertTime = chrono::steady_clock::now() - start;
+
+    // Enough rounds for about a million lookups
+    size_t rounds = max<size_t>(1, 1000000 / max<size_t>(1, queries.size()));
+    size_t found = 0;
+    start = chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (const auto& q : queries) {
+            if (table.Search(q) != nullptr) ++found;
+        }
+    }
+    chrono::duration<double, nano> lookupTime = chrono::steady_clock::now() - start;
+    double lookups = static_cast<double>(rounds * queries.size());
+
+    vector<size_t> probes = table.ProbeLengthCounts();
+    double totalGroups = 0;
+    for (size_t g = 1; g < probes.size(); ++g) {
+        totalGroups += static_cast<double>(g * probes[g]);
+    }
+
+    cout << left << setw(16) << Hasher::Name() << right << fixed << setprecision(1)
+         << setw(10) << insertTime.count() / courses.size() << " ns"
+         << setw(10) << lookupTime.count() / lookups << " ns"
+         << setw(10) << (lookups / lookupTime.count()) * 1000.0 << " M/s"
+         << setw(8) << setprecision(3) << totalGroups / courses.size()
+         << setw(6) << probes.size() - 1 << "   ";
+    for (size_t g = 1; g < probes.size() && g <= 4; ++g) {
+        cout << " " << g << ":" << setprecision(1) << 100.0 * probes[g] / courses.size() << "%";
+    }
+    cout << (found == static_cast<size_t>(lookups) ? "" : "  (lookup mismatch!)") << endl;
+}
+
+// Compares the built-in hashers on the courses of a CSV file
+bool RunHashBenchmark(const string& filename) {
+    HashCatalogStore loader;
+    if (!LoadCourses(filename, loader)) {
+        return false;
+    }
+
+    vector<Course> courses = loader.Table().GetAllCourses();
+    if (courses.empty()) {
+        cout << "No courses to benchmark." << endl;
+        return false;
+    }
+    vector<string> queries;
+    for (const auto& c : courses) {
+        queries.push_back(c.courseNumber.ToString());
+    }
+
+    cout << "Hash benchmark over " << courses.size() << " courses\n"
+         << left << setw(16) << "hasher" << right << setw(13) << "insert/op" << setw(13) << "lookup/op"
+         << setw(14) << "throughput" << setw(8) << "groups" << setw(6) << "max" << "    probe-length share" << endl;
+    BenchmarkHasher<PolynomialHasher>(courses, queries);
+    BenchmarkHasher<Fnv1aHasher>(courses, queries);
+    BenchmarkHasher<SplitMixHasher>(courses, queries);
+    BenchmarkHasher<WyMixHasher>(courses, queries);
+    BenchmarkHasher<SipHasher>(courses, queries);
+    return true;
+}
+
+// Times a full course listing two ways at growing catalog sizes: the old
+// copy-and-sort through GetAllCourses and the ordered index. Cost per
+// course grows with log n for the first and stays flat for the second.
+bool RunListBenchmark(const string& filename) {
+    HashCatalogStore loader;
+    if (!LoadCourses(filename, loader)) {
+        return false;
+    }
+
+    vector<Course> courses = loader.Table().GetAllCourses();
+    if (courses.empty()) {
+        cout << "No courses to benchmark." << endl;
+        return false;
+    }
+    shuffle(courses.begin(), courses.end(), mt19937_64(42));
+
+    cout << "Listing benchmark (output discarded)\n"
+         << right << setw(10) << "courses" << setw(17) << "copy+sort/course" << setw(17) << "ordered/course"
+         << setw(10) << "speedup" << endl;
+
+    for (size_t n = max<size_t>(1, courses.size() / 8); ; n = min(courses.size(), n * 2)) {
+        HashTable table;
+        table.BeginBulkLoad();
+        for (size_t i = 0; i < n; ++i) {
+            table.Insert(courses[i]);
+        }
+        table.EndBulkLoad();
+        table.FinishRehash();
+
+        // Enough rounds for about two million listed courses per method
+        size_t rounds = max<size_t>(1, 2000000 / n);
+        size_t checksum = 0;
+
+        auto start = chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; ++r) {
+            vector<Course> all = table.GetAllCourses();
+            sort(all.begin(), all.end(), [](const Course& a, const Course& b) {
+                return a.courseNumber < b.courseNumber;
+                });
+            for (const Course& c : all) checksum += c.courseTitle.View().size();
+        }
+        chrono::duration<double, nano> sortTime = chrono::steady_clock::now() - start;
+
+        start = chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; ++r) {
+            table.ForEachInOrder([&](const Course& c) { checksum -= c.courseTitle.View().size(); });
+        }
+        chrono::duration<double, nano> orderedTime = chrono::steady_clock::now() - start;
+
+        double listed = static_cast<double>(rounds * n);
+        cout << setw(10) << n << fixed << setprecision(1)
+             << setw(14) << sortTime.count() / listed << " ns"
+             << setw(14) << orderedTime.count() / listed << " ns"
+             << setw(9) << sortTime.count() / orderedTime.count() << "x"
+             << (checksum == 0 ? "" : "  (listing mismatch!)") << endl;
+
+        if (n == courses.size()) break;
+    }
+    return true;
+}
+
+// Parses a CSV file the way LoadCourses did before it mapped files: getline
+// into a string, Trim, then the stream tokenizer of SplitCSV. Returns the
+// total number of prerequisites of the courses built (none are stored).
+size_t ParseCoursesByStream(const string& filename) {
+    ifstream file(filename);
+    string line;
+    size_t checksum = 0;
+    while (getline(file, line)) {
+        line = Trim(line);
+        if (line.empty()) continue;
+        vector<string> tokens = SplitCSV(line);
+        if (tokens.size() < 2) continue;
+        checksum += CourseFromTokens(tokens).prerequisites.size() + 1;
+    }
+    return checksum;
+}
+
+// The same parse over a mapped file with string_view tokens
+size_t ParseCoursesByMapping(const string& filename) {
+    MappedFile file;
+    if (!file.Open(filename)) return 0;
+    size_t checksum = 0;
+    ForEachCSVLine(file.View(), [&](int, const vector<string_view>& tokens) {
+        if (tokens.size() >= 2) checksum += CourseFromTokens(tokens).prerequisites.size() + 1;
+        });
+    return checksum;
+}
 
-using namespace std;
+// Compares parsing a CSV file through ifstream and stringstream with
+// parsing it in place through a memory mapping, then times full loads on
+// 1, 2, 4... parsing threads
+bool RunLoadBenchmark(const string& filename) {
+    MappedFile file;
+    if (!file.Open(filename)) {
+        cout << "Error: Cannot open file '" << filename << "'." << endl;
+        return false;
+    }
+    double megabytes = file.View().size() / (1024.0 * 1024.0);
+    file.Close();
 
-// ===============================
-// STRUCT DEFINITION
-// ===============================
+    // Titles parsed here, outside any load, go to a pool of the benchmark's
+    TitlePool titles;
+    TitleScope titleScope(&titles);
 
-// Represents one course and its related information
-struct Course {
-    string courseNumber;             // e.g., "CSCI200"
-    string courseTitle;              // e.g., "Data Structures"
-    vector<string> prerequisites;    // e.g., {"CSCI101"}
-};
+    // A first pass interns every key and title and warms the page cache,
+    // so both methods are then timed on equal terms (best of three)
+    size_t expected = ParseCoursesByMapping(filename);
+    double best[2] = { 1e300, 1e300 };
+    bool match = true;
+    for (int round = 0; round < 3; ++round) {
+        for (int method = 0; method < 2; ++method) {
+            auto start = chrono::steady_clock::now();
+            size_t checksum = method == 0 ? ParseCoursesByStream(filename) : ParseCoursesByMapping(filename);
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            best[method] = min(best[method], elapsed.count());
+            match = match && checksum == expected;
+        }
+    }
 
-// ===============================
-// HELPER FUNCTIONS
-// ===============================
+    cout << "Parse benchmark over " << fixed << setprecision(1) << megabytes << " MB\n"
+         << left << setw(24) << "method" << right << setw(13) << "time" << setw(12) << "MB/s" << endl;
+    const char* names[2] = { "ifstream + stringstream", "mapped + string_view" };
+    for (int method = 0; method < 2; ++method) {
+        cout << left << setw(24) << names[method] << right << setw(10) << best[method] << " ms"
+             << setw(12) << megabytes / (best[method] / 1000.0) << endl;
+    }
+    cout << "Speedup: " << best[0] / best[1] << "x" << (match ? "" : "  (parse mismatch!)") << endl;
 
-// Removes leading and trailing whitespace from a string
-string Trim(const string& str) {
-    size_t start = str.find_first_not_of(" \t\r\n");
-    if (start == string::npos) return "";  // If string is empty or all spaces
-    size_t end = str.find_last_not_of(" \t\r\n");
-    return str.substr(start, end - start + 1);
+    // Full loads into the hash table as the parsing threads double, up to
+    // the hardware thread count (at least 4)
+    unsigned maxThreads = max(4u, thread::hardware_concurrency());
+    cout << "\nFull load into the hash table\n" << setw(8) << "threads" << setw(13) << "time"
+         << setw(10) << "speedup" << endl;
+    double singleThreaded = 0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        LoadOptions options;
+        options.loadThreads = threads;
+        HashCatalogStore store;
+        streambuf* console = cout.rdbuf(nullptr);  // silence load messages
+        auto start = chrono::steady_clock::now();
+        LoadCourses(filename, store, options);
+        chrono::duration<double, milli> loadTime = chrono::steady_clock::now() - start;
+        cout.rdbuf(console);
+
+        if (threads == 1) singleThreaded = loadTime.count();
+        cout << setw(8) << threads << setw(10) << loadTime.count() << " ms"
+             << setw(9) << singleThreaded / loadTime.count() << "x" << endl;
+    }
+    cout << defaultfloat;
+    return match;
 }
 
-// Converts a string to uppercase for consistent comparisons
-string ToUpper(const string& s) {
-    string result = s;
-    transform(result.begin(), result.end(), result.begin(), ::toupper);
-    return result;
+// Processor timestamp counter, or 0 where there is none to read
+uint64_t CycleCount() {
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+    return __rdtsc();
+#else
+    return 0;
+#endif
 }
 
-// Normalizes a course number by trimming and converting to uppercase
-string NormalizeCourseNumber(const string& s) {
-    return ToUpper(Trim(s));
+// Splits text into trimmed fields with one kernel set, as the loader does,
+// and returns the number of field characters (a checksum)
+size_t ScanFields(const TextScanner& scanner, string_view text) {
+    DelimiterCursor delimiters(scanner, text);
+    size_t checksum = 0;
+    const char* next = text.data();
+    const char* end = next + text.size();
+    while (next != end) {
+        const char* delimiter = delimiters.Next();
+        const char* first = scanner.skipSpace(next, delimiter);
+        checksum += static_cast<size_t>(scanner.skipSpaceBackward(first, delimiter) - first);
+        next = delimiter == end ? end : delimiter + 1;
+    }
+    return checksum;
 }
 
-// Splits a CSV line into tokens
-vector<string> SplitCSV(const string& line) {
-    vector<string> tokens;
-    string token;
-    stringstream ss(line);
-    while (getline(ss, token, ',')) {
-        tokens.push_back(Trim(token));
+// Compares the scalar, SSE2 and AVX2 scanning kernels in bytes per cycle
+// (timestamp-counter ticks) on the fields of a CSV file, and on padded
+// fields whose long whitespace runs let the vector kernels stride
+bool RunScanBenchmark(const string& filename) {
+    MappedFile file;
+    if (!file.Open(filename) || file.View().empty()) {
+        cout << "Error: Cannot read file '" << filename << "'." << endl;
+        return false;
     }
-    return tokens;
+
+    string padded;
+    for (int i = 0; i < 4096; ++i) {
+        padded += string(40, ' ') + "CSCI" + to_string(i) + string(40, ' ') + (i % 4 == 3 ? "\n" : ",");
+    }
+
+    struct Workload {
+        const char* name;
+        string_view text;
+    };
+    Workload workloads[2] = { { "CSV fields", file.View() }, { "padded fields", padded } };
+
+    cout << "Scan benchmark (bytes per cycle; GB/s)\n" << left << setw(10) << "kernels" << right;
+    for (const Workload& workload : workloads) {
+        cout << setw(24) << workload.name;
+    }
+    cout << endl;
+
+    size_t expected[2] = { ScanFields(Scanner(), workloads[0].text), ScanFields(Scanner(), workloads[1].text) };
+    bool match = true;
+    for (const TextScanner& scanner : AvailableScanners()) {
+        cout << left << setw(10) << scanner.name << right << fixed << setprecision(2);
+        for (int w = 0; w < 2; ++w) {
+            // Enough rounds for about 256 MB of text
+            size_t rounds = max<size_t>(1, (256u << 20) / workloads[w].text.size());
+            size_t checksum = 0;
+            auto start = chrono::steady_clock::now();
+            uint64_t startCycles = CycleCount();
+            for (size_t r = 0; r < rounds; ++r) {
+                checksum += ScanFields(scanner, workloads[w].text);
+            }
+            uint64_t cycles = CycleCount() - startCycles;
+            chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+            match = match && checksum == expected[w] * rounds;
+
+            double bytes = static_cast<double>(workloads[w].text.size()) * rounds;
+            ostringstream cell;
+            cell << fixed << setprecision(2);
+            if (cycles != 0) {
+                cell << bytes / cycles << " B/c; ";
+            }
+            cell << bytes / elapsed.count() << " GB/s";
+            cout << setw(24) << cell.str();
+        }
+        cout << endl;
+    }
+    cout << defaultfloat << "Loader uses: " << Scanner().name << (match ? "" : "  (scan mismatch!)") << endl;
+    return match;
 }
 
-// ===============================
-// HASH TABLE CLASS
-// ===============================
+// Times one storage layout: a bulk load, lookups of every course and full
+// in-order listings
+void BenchmarkStore(StorageBackend backend, const vector<Course>& courses, const vector<string>& queries) {
+    shared_ptr<CatalogStore> store = MakeCatalogStore(backend);
 
-class HashTable {
-private:
-    // Each bucket contains a list of Courses (to handle collisions)
-    vector<list<Course>> table;
-    size_t tableSize;
+    auto start = chrono::steady_clock::now();
+    store->BeginBulkLoad();
+    for (const auto& c : courses) {
+        store->Insert(c);
+    }
+    store->EndBulkLoad();
+    store->FinishLoading(LoadOptions());
+    chrono::duration<double, nano> loadTime = chrono::steady_clock::now() - start;
 
-    // Hash function — converts courseNumber into an index
-    unsigned int Hash(string key) const {
-        unsigned int hashValue = 0;
-        for (char c : key) {
-            hashValue = hashValue * 31 + toupper(c);
+    // Enough rounds for about a million lookups and listed courses
+    size_t rounds = max<size_t>(1, 1000000 / queries.size());
+    size_t found = 0;
+    start = chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (const auto& q : queries) {
+            if (store->Search(q) != nullptr) ++found;
         }
-        return hashValue % tableSize;
     }
+    chrono::duration<double, nano> lookupTime = chrono::steady_clock::now() - start;
 
-public:
-    // Constructor
-    HashTable(size_t size = 20) {
-        tableSize = size;
-        table.resize(tableSize);
+    size_t listed = 0;
+    start = chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        store->ForEachInOrder([&](const Course&) { ++listed; });
     }
+    chrono::duration<double, nano> listTime = chrono::steady_clock::now() - start;
 
-    // Insert a new course into the hash table
-    void Insert(const Course& course) {
-        string key = NormalizeCourseNumber(course.courseNumber);
-        unsigned int index = Hash(key);
+    double operations = static_cast<double>(rounds * queries.size());
+    cout << left << setw(16) << store->Name() << right << fixed << setprecision(1)
+         << setw(10) << loadTime.count() / courses.size() << " ns"
+         << setw(10) << lookupTime.count() / operations << " ns"
+         << setw(10) << listTime.count() / operations << " ns"
+         << (found == rounds * queries.size() && listed == found ? "" : "  (mismatch!)") << endl;
+}
 
-        // Avoid duplicates
-        for (const auto& c : table[index]) {
-            if (NormalizeCourseNumber(c.courseNumber) == key) {
-                cout << "Warning: Duplicate course '" << course.courseNumber << "' found. Skipping duplicate." << endl;
-                return;
-            }
-        }
+// Compares the storage layouts on the courses of a CSV file
+bool RunStoreBenchmark(const string& filename) {
+    HashCatalogStore loader;
+    if (!LoadCourses(filename, loader)) {
+        return false;
+    }
 
-        table[index].push_back(course);
+    vector<Course> courses = loader.Table().GetAllCourses();
+    if (courses.empty()) {
+        cout << "No courses to benchmark." << endl;
+        return false;
+    }
+    vector<string> queries;
+    for (const auto& c : courses) {
+        queries.push_back(c.courseNumber.ToString());
     }
 
-    // Search for a course by course number
-    Course* Search(const string& courseNumber) {
-        string key = NormalizeCourseNumber(courseNumber);
-        unsigned int index = Hash(key);
+    cout << "Storage benchmark over " << courses.size() << " courses (per course)\n"
+         << left << setw(16) << "layout" << right << setw(13) << "load" << setw(13) << "lookup"
+         << setw(13) << "list" << endl;
+    BenchmarkStore(StorageBackend::Vector, courses, queries);
+    BenchmarkStore(StorageBackend::Tree, courses, queries);
+    BenchmarkStore(StorageBackend::BPlusTree, courses, queries);
+    BenchmarkStore(StorageBackend::Partitioned, courses, queries);
+    BenchmarkStore(StorageBackend::RobinHood, courses, queries);
+    BenchmarkStore(StorageBackend::Hash, courses, queries);
+    return true;
+}
 
-        for (auto& c : table[index]) {
-            if (NormalizeCourseNumber(c.courseNumber) == key) {
-                return &c;  // Return pointer to found course
+// Runs threads readers, each making lookupsPerThread lookups, and returns
+// their combined rate in lookups per microsecond and the lookups that found
+// a course. With a writer, another thread meanwhile clears the table and
+// inserts every course again, over and over; insertRate receives its
+// inserts per microsecond.
+double TimeConcurrentLookups(ConcurrentHashTable<>& table, const vector<Course>& courses,
+                             const vector<string>& queries, size_t threads, size_t lookupsPerThread,
+                             bool withWriter, size_t& found, double& insertRate) {
+    atomic<size_t> hits{ 0 };
+    atomic<size_t> readersLeft{ threads };
+    vector<thread> workers;
+    auto start = chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            size_t local = 0;
+            size_t index = (t * 7919) % queries.size();
+            for (size_t i = 0; i < lookupsPerThread; ++i) {
+                local += table.Search(queries[index], [](const Course&) {}) ? 1 : 0;
+                if (++index == queries.size()) index = 0;
             }
-        }
-        return nullptr;
+            hits.fetch_add(local);
+            readersLeft.fetch_sub(1);
+        });
     }
 
-    // Retrieve all courses in a flat vector (for sorting and listing)
-    vector<Course> GetAllCourses() const {
-        vector<Course> allCourses;
-        for (const auto& bucket : table) {
-            for (const auto& course : bucket) {
-                allCourses.push_back(course);
+    size_t inserts = 0;
+    thread writer;
+    if (withWriter) {
+        writer = thread([&] {
+            while (readersLeft.load() != 0) {
+                table.Clear();
+                for (size_t i = 0; i < courses.size() && readersLeft.load() != 0; ++i, ++inserts) {
+                    table.Insert(courses[i]);
+                }
             }
-        }
-        return allCourses;
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
     }
+    chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - start;
+    insertRate = 0;
+    if (withWriter) {
+        writer.join();
+        insertRate = static_cast<double>(inserts) / elapsed.count();
 
-    // Clear all stored data
-    void Clear() {
-        for (auto& bucket : table) {
-            bucket.clear();
+        // Leave the table full again for the next run
+        table.Clear();
+        for (const auto& c : courses) {
+            table.Insert(c);
         }
     }
-};
 
-// ===============================
-// CORE FUNCTIONALITY
-// ===============================
+    found = hits.load();
+    return static_cast<double>(threads * lookupsPerThread) / elapsed.count();
+}
 
-// Loads courses from a CSV file into the hash table
-bool LoadCourses(const string& filename, HashTable& courseTable) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cout << "Error: Cannot open file '" << filename << "'. Please check the file and try again.\n" << endl;
+// Measures ConcurrentHashTable lookup throughput with 1 to N reader threads
+// (N = hardware threads, at least 4) over the courses of a CSV file, alone
+// and with a writer thread clearing and refilling the table throughout.
+// Lookups during a refill may miss, so only the reader-only runs must find
+// every course.
+bool RunConcurrentBenchmark(const string& filename) {
+    HashCatalogStore loader;
+    if (!LoadCourses(filename, loader)) {
+        return false;
+    }
+    vector<Course> courses = loader.Table().GetAllCourses();
+    if (courses.empty()) {
+        cout << "No courses to benchmark." << endl;
         return false;
     }
 
-    courseTable.Clear();  // Clear any existing data
-    string line;
-    int lineNumber = 0;
+    ConcurrentHashTable<> table(courses.size());
+    vector<string> queries;
+    for (const auto& c : courses) {
+        table.Insert(c);
+        queries.push_back(c.courseNumber.ToString());
+    }
 
-    while (getline(file, line)) {
-        lineNumber++;
-        line = Trim(line);
-        if (line.empty()) continue;
+    const size_t lookupsPerThread = 2000000;
+    size_t maxThreads = max<size_t>(4, thread::hardware_concurrency());
+    double singleThreadRate = 0;
 
-        vector<string> tokens = SplitCSV(line);
+    cout << "Concurrent lookup benchmark over " << courses.size() << " courses ("
+         << thread::hardware_concurrency() << " hardware threads)\n"
+         << setw(8) << "threads" << setw(14) << "total M/s" << setw(12) << "speedup"
+         << setw(18) << "with writer M/s" << setw(10) << "found" << setw(16) << "writer M ins/s" << endl;
 
-        if (tokens.size() < 2) {
-            cout << "Warning (line " << lineNumber << "): Skipping invalid line." << endl;
-            continue;
-        }
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        size_t found = 0;
+        double insertRate = 0;
+        double rate = TimeConcurrentLookups(table, courses, queries, threads, lookupsPerThread, false, found, insertRate);
+        if (threads == 1) singleThreadRate = rate;
+        bool complete = found == threads * lookupsPerThread;
+        double sharedRate = TimeConcurrentLookups(table, courses, queries, threads, lookupsPerThread, true, found, insertRate);
+
+        cout << setw(8) << threads << fixed << setprecision(1) << setw(14) << rate
+             << setw(11) << setprecision(2) << rate / singleThreadRate << "x"
+             << setw(18) << setprecision(1) << sharedRate
+             << setw(9) << 100.0 * found / (threads * lookupsPerThread) << "%"
+             << setw(16) << setprecision(2) << insertRate
+             << (complete ? "" : "  (lookup mismatch!)") << defaultfloat << endl;
+    }
+    return true;
+}
+
+// Shows what a hash-flooding attack does to the unseeded default hasher and
+// that the seeded SipHasher is unaffected. The crafted course numbers are
+// found offline, as an attacker would: every one has the same home group
+// in any table of up to 1024 groups.
+bool RunFloodBenchmark() {
+    const size_t keyCount = 4096;
+    TitlePool titles;
+    TitleScope titleScope(&titles);
+    vector<Course> ordinary;
+    vector<Course> crafted;
+    char buffer[16];
 
+    for (uint32_t i = 0; crafted.size() < keyCount; ++i) {
+        snprintf(buffer, sizeof(buffer), "Z%07u", static_cast<unsigned>(i % 10000000));
         Course course;
-        course.courseNumber = tokens[0];
-        course.courseTitle = tokens[1];
+        course.courseNumber = CourseKey::FromString(buffer);
+        course.courseTitle = CourseTitle::FromString("Flood test");
 
-        for (size_t i = 2; i < tokens.size(); ++i) {
-            if (!tokens[i].empty()) {
-                course.prerequisites.push_back(tokens[i]);
-            }
+        if (ordinary.size() < keyCount) {
+            ordinary.push_back(course);
+        }
+        if (((SplitMixHasher::Hash(course.courseNumber) >> 7) & 1023) == 0) {
+            crafted.push_back(course);
         }
-
-        courseTable.Insert(course);
     }
 
-    file.close();
+    for (const vector<Course>* courses : { &ordinary, &crafted }) {
+        vector<string> queries;
+        for (const auto& c : *courses) {
+            queries.push_back(c.courseNumber.ToString());
+        }
 
-    cout << "Courses loaded successfully.\n" << endl;
+        cout << (courses == &ordinary ? "Ordinary" : "Crafted (colliding)") << " course numbers, "
+             << courses->size() << " keys\n"
+             << left << setw(16) << "hasher" << right << setw(13) << "insert/op" << setw(13) << "lookup/op"
+             << setw(14) << "throughput" << setw(8) << "groups" << setw(6) << "max" << "    probe-length share" << endl;
+        BenchmarkHasher<SplitMixHasher>(*courses, queries);
+        BenchmarkHasher<SipHasher>(*courses, queries);
+        cout << endl;
+    }
     return true;
 }
 
-// Prints a sorted list of all courses (alphanumeric)
-void PrintCourseList(const HashTable& courseTable) {
-    vector<Course> allCourses = courseTable.GetAllCourses();
+// ===============================
+// ALLOCATION CHECK
+// ===============================
+
+#ifdef ADVISING_COUNT_ALLOCATIONS
+// In an allocation-check build every global operator new is counted, so
+// --check-alloc can prove that a path makes no heap allocation. All the
+// plain, array and nothrow forms are replaced together so each delete
+// matches its new; the over-aligned forms are left alone, as nothing here
+// needs them.
+static atomic<size_t> heapAllocations{ 0 };
 
-    if (allCourses.empty()) {
-        cout << "No courses loaded. Please load data first.\n" << endl;
-        return;
+static void* CountedAllocate(size_t size) noexcept {
+    heapAllocations.fetch_add(1, memory_order_relaxed);
+    return malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(size_t size) {
+    if (void* p = CountedAllocate(size)) {
+        return p;
     }
+    throw bad_alloc();
+}
 
-    // Sort alphabetically by normalized course number
-    sort(allCourses.begin(), allCourses.end(), [](const Course& a, const Course& b) {
-        return NormalizeCourseNumber(a.courseNumber) < NormalizeCourseNumber(b.courseNumber);
-        });
+void* operator new[](size_t size) {
+    return operator new(size);
+}
 
-    cout << "\nHere is a sample schedule:" << endl;
-    for (const auto& c : allCourses) {
-        cout << c.courseNumber << ", " << c.courseTitle << endl;
-    }
-    cout << "\n";
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    return CountedAllocate(size);
 }
 
-// Prints detailed information for a specific course
-void PrintCourseInfo(HashTable& courseTable, const string& query) {
-    Course* course = courseTable.Search(query);
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return CountedAllocate(size);
+}
 
-    if (course == nullptr) {
-        cout << "Course not found.\n" << endl;
-        return;
-    }
+// GCC flags free() in an inlined operator delete as a mismatch for new
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    free(p);
+}
 
-    cout << "\n" << course->courseNumber << ", " << course->courseTitle << endl;
+void operator delete[](void* p) noexcept {
+    free(p);
+}
 
-    if (course->prerequisites.empty()) {
-        cout << "Prerequisites: None\n" << endl;
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, const nothrow_t&) noexcept {
+    free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+// Loads a CSV file into every storage layout with the given options and
+// runs a batch of lookups (each course number as stored, lower-cased and
+// padded, plus unknown numbers) through Search(string_view), checking that
+// none of them allocates. Only an allocation-check build can count.
+bool RunAllocationCheck(const string& filename, const LoadOptions& options) {
+#ifndef ADVISING_COUNT_ALLOCATIONS
+    (void)filename;
+    (void)options;
+    cout << "Allocation checks need a build with ADVISING_COUNT_ALLOCATIONS defined." << endl;
+    return false;
+#else
+    HashCatalogStore loader;
+    if (!LoadCourses(filename, loader)) {
+        return false;
     }
-    else {
-        cout << "Prerequisites: ";
-        for (size_t i = 0; i < course->prerequisites.size(); ++i) {
-            cout << course->prerequisites[i];
-            if (i < course->prerequisites.size() - 1) cout << ", ";
+    vector<string> queries;
+    loader.Table().ForEachInOrder([&](const Course& course) {
+        string number = course.courseNumber.ToString();
+        queries.push_back(number);
+        transform(number.begin(), number.end(), number.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        queries.push_back("  " + number + " ");
+        });
+    queries.push_back("ZZZ999");
+    queries.push_back("NOSUCHCOURSE12345");
+    queries.push_back("interdisciplinarystudies101");  // a department name too long for a short string
+    queries.push_back("");
+
+    bool clean = true;
+    for (StorageBackend backend : { StorageBackend::Vector, StorageBackend::Tree, StorageBackend::BPlusTree,
+                                    StorageBackend::Partitioned, StorageBackend::RobinHood, StorageBackend::Hash }) {
+        LoadOptions storeOptions = options;
+        storeOptions.backend = backend;
+        shared_ptr<CatalogStore> store = MakeCatalogStore(backend, storeOptions.seededHash);
+        if (!LoadCourses(filename, *store, storeOptions)) {
+            return false;
         }
-        cout << "\n" << endl;
+
+        // One uncounted pass first: shared tables built on first use (such as
+        // the long-identifier table) may allocate once, but not per lookup
+        for (const string& query : queries) {
+            store->Search(string_view(query));
+        }
+
+        size_t found = 0;
+        size_t before = heapAllocations.load(memory_order_relaxed);
+        for (const string& query : queries) {
+            if (store->Search(string_view(query)) != nullptr) ++found;
+        }
+        size_t allocations = heapAllocations.load(memory_order_relaxed) - before;
+
+        cout << left << setw(16) << store->Name() << right << setw(8) << queries.size() << " lookups"
+             << setw(8) << found << " found" << setw(8) << allocations << " allocations"
+             << (allocations == 0 ? "" : "  (FAILED)") << endl;
+        clean = clean && allocations == 0;
     }
+    cout << (clean ? "No lookup allocated." : "Some lookups allocated.") << endl;
+    return clean;
+#endif
 }
 
 // ===============================
 // MENU SYSTEM
 // ===============================
 
-void DisplayMenu() {
-    HashTable courseTable;  // Hash table data structure
+// loadOptions are applied to every load. An embedded build serves its
+// compiled-in catalog and has no load option.
+void DisplayMenu(const LoadOptions& loadOptions) {
+#ifdef ADVISING_EMBEDDED_CATALOG
+    EmbeddedCatalog courseTable;  // Compiled-in catalog
+    bool dataLoaded = true;
+    (void)loadOptions;
+#else
+    CatalogHandle courseTable;  // Published hash table snapshots
     bool dataLoaded = false;
+#endif
 
     cout << "Welcome to the course planner.\n" << endl;
 
     while (true) {
+#ifndef ADVISING_EMBEDDED_CATALOG
         cout << "1. Load Data Structure." << endl;
+#endif
         cout << "2. Print Course List." << endl;
         cout << "3. Print Course." << endl;
+        cout << "4. Print Catalog Statistics." << endl;
+        cout << "5. Find Courses by Prefix." << endl;
+        cout << "6. List Courses in Range." << endl;
+#ifndef ADVISING_EMBEDDED_CATALOG
+        cout << "7. Reload One Department." << endl;
+#endif
+        cout << "8. Print Memory Usage." << endl;
+#ifndef ADVISING_EMBEDDED_CATALOG
+        cout << "10. Add or Update One Course." << endl;
+        cout << "11. Remove One Course." << endl;
+#endif
         cout << "9. Exit\n" << endl;
         cout << "What would you like to do? " << endl;
 
@@ -260,26 +5831,29 @@ void DisplayMenu() {
         getline(cin, choice);
         choice = Trim(choice);
 
+#ifndef ADVISING_EMBEDDED_CATALOG
         if (choice == "1") {
             cout << "Enter the file name to load: \n" << endl;
             string filename;
             getline(cin, filename);
             filename = Trim(filename);
 
-            if (LoadCourses(filename, courseTable)) {
+            if (LoadCourses(filename, courseTable, loadOptions)) {
                 dataLoaded = true;
             }
-            else {
-                dataLoaded = false;
+            else if (dataLoaded) {
+                cout << "The previously loaded courses are still available.\n" << endl;
             }
 
         }
-        else if (choice == "2") {
+        else
+#endif
+        if (choice == "2") {
             if (!dataLoaded) {
                 cout << "Please load data first using option 1.\n" << endl;
             }
             else {
-                PrintCourseList(courseTable);
+                PrintCourseList(*courseTable.Snapshot());
             }
 
         }
@@ -292,10 +5866,100 @@ void DisplayMenu() {
                 string courseNum;
                 getline(cin, courseNum);
                 courseNum = Trim(courseNum);
-                PrintCourseInfo(courseTable, courseNum);
+                PrintCourseInfo(*courseTable.Snapshot(), courseNum);
+            }
+
+        }
+        else if (choice == "4") {
+            if (!dataLoaded) {
+                cout << "Please load data first using option 1.\n" << endl;
+            }
+            else {
+                PrintCatalogStatistics(*courseTable.Snapshot());
+            }
+
+        }
+        else if (choice == "5") {
+            if (!dataLoaded) {
+                cout << "Please load data first using option 1.\n" << endl;
+            }
+            else {
+                cout << "\nEnter a course number prefix (e.g. CSCI2*): " << endl;
+                string query;
+                getline(cin, query);
+                cout << "\n";
+                PrintCoursesByPrefix(*courseTable.Snapshot(), query);
+            }
+
+        }
+        else if (choice == "6") {
+            if (!dataLoaded) {
+                cout << "Please load data first using option 1.\n" << endl;
+            }
+            else {
+                cout << "\nEnter the first course number of the range: " << endl;
+                string first;
+                getline(cin, first);
+                cout << "Enter the last course number of the range: " << endl;
+                string last;
+                getline(cin, last);
+                cout << "\n";
+                PrintCourseRange(*courseTable.Snapshot(), first, last);
+            }
+
+        }
+#ifndef ADVISING_EMBEDDED_CATALOG
+        else if (choice == "7") {
+            if (!dataLoaded) {
+                cout << "Please load data first using option 1.\n" << endl;
+            }
+            else {
+                cout << "Enter the department to reload (e.g. CSCI): \n" << endl;
+                string department;
+                getline(cin, department);
+                cout << "Enter the file name to load: \n" << endl;
+                string filename;
+                getline(cin, filename);
+                ReloadDepartment(Trim(filename), department, courseTable, loadOptions);
+            }
+
+        }
+#endif
+        else if (choice == "8") {
+            if (!dataLoaded) {
+                cout << "Please load data first using option 1.\n" << endl;
+            }
+            else {
+                PrintMemoryUsage(*courseTable.Snapshot());
+            }
+
+        }
+#ifndef ADVISING_EMBEDDED_CATALOG
+        else if (choice == "10") {
+            if (!dataLoaded) {
+                cout << "Please load data first using option 1.\n" << endl;
+            }
+            else {
+                cout << "Enter the course as a CSV line (number,title,prerequisites...): \n" << endl;
+                string line;
+                getline(cin, line);
+                UpdateCourse(line, courseTable);
+            }
+
+        }
+        else if (choice == "11") {
+            if (!dataLoaded) {
+                cout << "Please load data first using option 1.\n" << endl;
+            }
+            else {
+                cout << "Enter the course number to remove: \n" << endl;
+                string courseNum;
+                getline(cin, courseNum);
+                RemoveCourse(Trim(courseNum), courseTable);
             }
 
         }
+#endif
         else if (choice == "9") {
             cout << "Thank you for using the course planner!" << endl;
             break;
@@ -311,7 +5975,130 @@ void DisplayMenu() {
 // MAIN FUNCTION
 // ===============================
 
-int main() {
-    DisplayMenu();
+// Command-line options:
+//   --frozen                         freeze the catalog into a minimal
+//                                    perfect hash after each load
+//   --store <layout>                 storage layout for loaded catalogs:
+//                                    vector, tree, bplus, partitioned,
+//                                    robinhood (allows editing single
+//                                    courses) or hash (the default)
+//   --threads <n>                    parse loaded files on n threads (default:
+//                                    one per core)
+//   --seeded-hash                    hash course numbers with SipHash under a
+//                                    random per-process key, so crafted
+//                                    catalogs cannot force collisions
+//   --bloom <rate>                   filter out lookups of unknown courses
+//                                    with a Bloom filter at the given
+//                                    false-positive rate (e.g. 0.01)
+//   --embed-catalog <csv> <header>   generate a header for an embedded build
+//                                    and exit
+//   --memory <csv>                   load the file with the options given
+//                                    before it, print its memory usage by
+//                                    category and exit
+//   --check-alloc <csv>              load the file into every layout with
+//                                    the options given before it, check that
+//                                    course lookups make no heap allocation
+//                                    and exit (allocation-check builds only)
+//   --bench-hash <csv>               compare the built-in hashers and exit
+//   --bench-flood                    compare default and seeded hashing on
+//                                    crafted colliding keys and exit
+//   --bench-concurrent <csv>         measure lookup scaling across threads
+//                                    and exit
+//   --bench-stores <csv>             compare the storage layouts and exit
+//   --bench-list <csv>               compare sorted listing by copy-and-sort
+//                                    with the ordered index and exit
+//   --bench-load <csv>               compare stream and memory-mapped CSV
+//                                    parsing, time loads across thread
+//                                    counts and exit
+//   --bench-scan <csv>               compare the scalar, SSE2 and AVX2
+//                                    delimiter and whitespace kernels and exit
+int main(int argc, char* argv[]) {
+    LoadOptions loadOptions;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--frozen") {
+            loadOptions.freezeCatalog = true;
+        }
+        else if (arg == "--store" && i + 1 < argc) {
+            string backend = argv[++i];
+            if (backend == "vector") {
+                loadOptions.backend = StorageBackend::Vector;
+            }
+            else if (backend == "tree") {
+                loadOptions.backend = StorageBackend::Tree;
+            }
+            else if (backend == "bplus") {
+                loadOptions.backend = StorageBackend::BPlusTree;
+            }
+            else if (backend == "partitioned") {
+                loadOptions.backend = StorageBackend::Partitioned;
+            }
+            else if (backend == "robinhood") {
+                loadOptions.backend = StorageBackend::RobinHood;
+            }
+            else if (backend == "hash") {
+                loadOptions.backend = StorageBackend::Hash;
+            }
+            else {
+                cout << "Unknown storage layout '" << backend << "'; using the hash table." << endl;
+            }
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            int threads = atoi(argv[++i]);
+            if (threads > 0) {
+                loadOptions.loadThreads = static_cast<unsigned>(threads);
+            }
+            else {
+                cout << "Thread count must be positive; using one per core." << endl;
+            }
+        }
+        else if (arg == "--seeded-hash") {
+            loadOptions.seededHash = true;
+        }
+        else if (arg == "--bloom" && i + 1 < argc) {
+            double rate = atof(argv[++i]);
+            if (rate > 0 && rate < 1) {
+                loadOptions.bloomFalsePositiveRate = rate;
+            }
+            else {
+                cout << "Bloom filter rate must be between 0 and 1; filter disabled." << endl;
+            }
+        }
+        else if (arg == "--embed-catalog" && i + 2 < argc) {
+            return WriteEmbeddedCatalog(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        }
+        else if (arg == "--memory" && i + 1 < argc) {
+            return RunMemoryReport(argv[i + 1], loadOptions) ? 0 : 1;
+        }
+        else if (arg == "--check-alloc" && i + 1 < argc) {
+            return RunAllocationCheck(argv[i + 1], loadOptions) ? 0 : 1;
+        }
+        else if (arg == "--bench-hash" && i + 1 < argc) {
+            return RunHashBenchmark(argv[i + 1]) ? 0 : 1;
+        }
+        else if (arg == "--bench-flood") {
+            return RunFloodBenchmark() ? 0 : 1;
+        }
+        else if (arg == "--bench-concurrent" && i + 1 < argc) {
+            return RunConcurrentBenchmark(argv[i + 1]) ? 0 : 1;
+        }
+        else if (arg == "--bench-stores" && i + 1 < argc) {
+            return RunStoreBenchmark(argv[i + 1]) ? 0 : 1;
+        }
+        else if (arg == "--bench-list" && i + 1 < argc) {
+            return RunListBenchmark(argv[i + 1]) ? 0 : 1;
+        }
+        else if (arg == "--bench-load" && i + 1 < argc) {
+            return RunLoadBenchmark(argv[i + 1]) ? 0 : 1;
+        }
+        else if (arg == "--bench-scan" && i + 1 < argc) {
+            return RunScanBenchmark(argv[i + 1]) ? 0 : 1;
+        }
+        else {
+            cout << "Unknown option '" << arg << "' ignored." << endl;
+        }
+    }
+
+    DisplayMenu(loadOptions);
     return 0;
 }
\ No newline at end of file